@@ -0,0 +1,856 @@
+// Benchmarks for easy_serialize library.
+//
+// Usage: bench_easy_serialize <benchmark> <variant>
+//
+// Each run prints throughput and peak RSS. Peak RSS only ever grows over the life of a process,
+// so compare variants in separate runs (see "make bench").
+
+#include "easy_serialize/json_lines_parallel_reader.hpp"
+#include "easy_serialize/json_lines_reader.hpp"
+#include "easy_serialize/json_push_reader.hpp"
+#include "easy_serialize/json_reader.hpp"
+#include "easy_serialize/json_writer.hpp"
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Large enum, like the event types in our logs.
+enum class EventType
+{
+  N = 256 // One past last valid value.
+};
+
+const char *to_string(EventType event_type)
+{
+  static const std::vector<std::string> names = []
+  {
+    std::vector<std::string> n;
+    for (int i = 0; i < static_cast<int>(EventType::N); ++i)
+    {
+      n.push_back("event_type_" + std::to_string(i));
+    }
+    return n;
+  }();
+  const auto i = static_cast<size_t>(event_type);
+  return i < names.size() ? names[i].c_str() : "";
+}
+
+namespace
+{
+  class Record
+  {
+  public:
+    int64_t id = 0;
+    std::string name;
+    double score = 0.0;
+    bool active = false;
+    std::vector<int32_t> counts;
+
+    template <class Archive>
+    void serialize(Archive &ar)
+    {
+      ar.ez("id", id);
+      ar.ez("name", name);
+      ar.ez("score", score);
+      ar.ez("active", active);
+      ar.ez_vector("counts", counts);
+    }
+  };
+
+  // The two members of Record a filter needs.
+  class RecordScore
+  {
+  public:
+    int64_t id = 0;
+    double score = 0.0;
+
+    template <class Archive>
+    void serialize(Archive &ar)
+    {
+      ar.ez("id", id);
+      ar.ez("score", score);
+    }
+  };
+
+  // Record with many fields, like the wide records read from logs.
+  class WideRecord
+  {
+  public:
+    static const size_t num_fields = 64;
+    int64_t fields[num_fields] = {};
+
+    static const char *key(size_t i)
+    {
+      static const std::vector<std::string> keys = []
+      {
+        std::vector<std::string> k;
+        for (size_t j = 0; j < num_fields; ++j)
+        {
+          k.push_back("field_number_" + std::to_string(j));
+        }
+        return k;
+      }();
+      return keys[i].c_str();
+    }
+
+    template <class Archive>
+    void serialize(Archive &ar)
+    {
+      for (size_t i = 0; i < num_fields; ++i)
+      {
+        ar.ez(key(i), fields[i]);
+      }
+    }
+  };
+
+  // Twins of the records that opt in to HasFixedFields, so the DOM reader binds them through a
+  // schema, to compare with reading the same JSON through serialize().
+  class FixedRecord : public Record
+  {
+  };
+  class FixedRecordScore : public RecordScore
+  {
+  };
+  class FixedWideRecord : public WideRecord
+  {
+  };
+
+}
+
+namespace easy_serialize
+{
+  template <>
+  struct HasFixedFields<FixedRecord> : std::true_type
+  {
+  };
+  template <>
+  struct HasFixedFields<FixedRecordScore> : std::true_type
+  {
+  };
+  template <>
+  struct HasFixedFields<FixedWideRecord> : std::true_type
+  {
+  };
+} // namespace easy_serialize
+
+namespace
+{
+  // Compact JSON array of wide records, with members in serialize() order or reversed.
+  std::string make_wide_records_json(size_t num_records, bool reversed)
+  {
+    std::string json = "[";
+    for (size_t i = 0; i < num_records; ++i)
+    {
+      json += i == 0 ? "{" : ",{";
+      for (size_t j = 0; j < WideRecord::num_fields; ++j)
+      {
+        const size_t field = reversed ? WideRecord::num_fields - 1 - j : j;
+        json += j == 0 ? "\"" : ",\"";
+        json += WideRecord::key(field);
+        json += "\":" + std::to_string(i + field);
+      }
+      json += "}";
+    }
+    json += "]";
+    return json;
+  }
+
+  class Samples
+  {
+  public:
+    std::vector<double> values;
+
+    template <class Archive>
+    void serialize(Archive &ar)
+    {
+      ar.ez_vector("values", values);
+    }
+  };
+
+  // Compact JSON array of doubles with 3 decimal places, like sensor readings.
+  std::string make_doubles_json(size_t num_values)
+  {
+    std::string json = "[";
+    char buf[64];
+    for (size_t i = 0; i < num_values; ++i)
+    {
+      const int n = std::snprintf(buf, sizeof(buf), "%s%zu.%03zu", i == 0 ? "" : ",", i % 100000, i % 1000);
+      json.append(buf, static_cast<size_t>(n));
+    }
+    json += "]";
+    return json;
+  }
+
+  // Compact JSON array of records, written directly so the objects never sit in memory.
+  std::string make_records_json(size_t num_records)
+  {
+    std::string json = "[";
+    char buf[256];
+    for (size_t i = 0; i < num_records; ++i)
+    {
+      const int n = std::snprintf(buf, sizeof(buf),
+                                  "%s{\"id\":%zu,\"name\":\"record number %zu\",\"score\":%zu.25,"
+                                  "\"active\":%s,\"counts\":[%zu,%zu,%zu,%zu]}",
+                                  i == 0 ? "" : ",", i, i, i % 1000, i % 2 ? "true" : "false",
+                                  i % 7, i % 11, i % 13, i % 17);
+      json.append(buf, static_cast<size_t>(n));
+    }
+    json += "]";
+    return json;
+  }
+
+  // JSON Lines of records, one per line.
+  std::string make_records_json_lines(size_t num_records)
+  {
+    std::string json;
+    char buf[256];
+    for (size_t i = 0; i < num_records; ++i)
+    {
+      const int n = std::snprintf(buf, sizeof(buf),
+                                  "{\"id\":%zu,\"name\":\"record number %zu\",\"score\":%zu.25,"
+                                  "\"active\":%s,\"counts\":[%zu,%zu,%zu,%zu]}\n",
+                                  i, i, i % 1000, i % 2 ? "true" : "false", i % 7, i % 11, i % 13, i % 17);
+      json.append(buf, static_cast<size_t>(n));
+    }
+    return json;
+  }
+
+  void report(const char *benchmark, const char *variant, size_t bytes, double seconds)
+  {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::printf("%-20s %-12s %9.1f MB/s  peak RSS %6ld MB\n", benchmark, variant,
+                static_cast<double>(bytes) / seconds / 1e6, usage.ru_maxrss / 1024);
+  }
+
+  template <typename Fn>
+  double time_seconds(Fn fn)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+
+  // Reads a large array of records with the DOM reader, through serialize() or a schema
+  // ("schema"), the streaming reader, or the DOM reader on a thread per core.
+  int bench_large_document(const std::string &variant)
+  {
+    const std::string json = make_records_json(1000000);
+    std::vector<Record> records;
+    easy_serialize::EasySerializeStatus status;
+    double seconds = 0.0;
+    if (variant == "dom")
+    {
+      seconds = time_seconds([&]
+                             { status = easy_serialize::from_json_string_vector_objects(json, records); });
+    }
+    else if (variant == "schema")
+    {
+      std::vector<FixedRecord> fixed_records;
+      seconds = time_seconds([&]
+                             { status = easy_serialize::from_json_string_vector_objects(json, fixed_records); });
+    }
+    else if (variant == "streaming")
+    {
+      seconds = time_seconds([&]
+                             { status = easy_serialize::from_json_string_vector_objects_streaming(json, records); });
+    }
+    else if (variant == "parallel")
+    {
+      seconds = time_seconds([&]
+                             { status = easy_serialize::from_json_string_vector_objects_parallel(json, records); });
+    }
+    else
+    {
+      return 2;
+    }
+    if (!status)
+    {
+      std::cerr << status.get_error_message() << "\n";
+      return 1;
+    }
+    report("large_document", variant.c_str(), json.size(), seconds);
+    return 0;
+  }
+
+  // Reads many small messages one at a time, allocating fresh reader memory for each or reusing
+  // a JsonReaderContext, optionally also reusing vector elements.
+  int bench_small_messages(const std::string &variant)
+  {
+    const size_t num_messages = 1000000;
+    const std::string json = make_records_json(1).substr(1);
+    const std::string message = json.substr(0, json.size() - 1);
+    Record record;
+    easy_serialize::EasySerializeStatus status;
+    double seconds = 0.0;
+    if (variant == "default")
+    {
+      seconds = time_seconds([&]
+                             {
+                               for (size_t i = 0; i < num_messages && status; ++i)
+                               {
+                                 status = easy_serialize::from_json_string(message, record);
+                               } });
+    }
+    else if (variant == "context" || variant == "reuse")
+    {
+      easy_serialize::JsonReaderContext context;
+      context.set_reuse_vector_elements(variant == "reuse");
+      seconds = time_seconds([&]
+                             {
+                               for (size_t i = 0; i < num_messages && status; ++i)
+                               {
+                                 status = easy_serialize::from_json_string(message, record, context);
+                               } });
+    }
+    else
+    {
+      return 2;
+    }
+    if (!status)
+    {
+      std::cerr << status.get_error_message() << "\n";
+      return 1;
+    }
+    report("small_messages", variant.c_str(), message.size() * num_messages, seconds);
+    return 0;
+  }
+
+  // Writes many small messages: compact like service-to-service traffic or indented, each into
+  // a new std::string, or compact into one reused send buffer (a std::string or a fixed span), or
+  // all of them as one compact array, where writing keys is much of the work.
+  int bench_write_messages(const std::string &variant)
+  {
+    const size_t num_messages = 1000000;
+    Record record;
+    record.id = 123456789;
+    record.name = "record number 123456789";
+    record.score = 87.25;
+    record.active = true;
+    record.counts = {3, 5, 7, 11};
+    const auto compact = easy_serialize::JsonIndent::compact;
+    size_t bytes = 0;
+    double seconds = 0.0;
+    if (variant == "compact" || variant == "indented")
+    {
+      const auto json_indent = variant == "compact" ? compact : easy_serialize::JsonIndent::two_spaces;
+      seconds = time_seconds([&]
+                             {
+                               for (size_t i = 0; i < num_messages; ++i)
+                               {
+                                 bytes += easy_serialize::to_json_string(record, json_indent).size();
+                               } });
+    }
+    else if (variant == "reuse")
+    {
+      std::string send_buffer;
+      seconds = time_seconds([&]
+                             {
+                               for (size_t i = 0; i < num_messages; ++i)
+                               {
+                                 send_buffer.clear();
+                                 easy_serialize::to_json_string(record, send_buffer, compact);
+                                 bytes += send_buffer.size();
+                               } });
+    }
+    else if (variant == "span")
+    {
+      char send_buffer[1024];
+      seconds = time_seconds([&]
+                             {
+                               for (size_t i = 0; i < num_messages; ++i)
+                               {
+                                 easy_serialize::SpanOutputStream os(send_buffer, sizeof(send_buffer));
+                                 easy_serialize::to_json_stream(os, record, compact);
+                                 bytes += os.size();
+                               } });
+    }
+    else if (variant == "array")
+    {
+      std::vector<Record> records(num_messages, record);
+      std::string json;
+      seconds = time_seconds([&]
+                             { easy_serialize::to_json_string_vector_objects(records, json, compact); });
+      bytes = json.size();
+    }
+    else
+    {
+      return 2;
+    }
+    report("write_messages", variant.c_str(), bytes, seconds);
+    return 0;
+  }
+
+  // Reads wide records with members in serialize() order, where each key is found by the first
+  // compare, or reversed, where each key is looked up in the object's member index. "find_member"
+  // parses the in order records the same way but looks up each key with rapidjson's FindMember(),
+  // as the reader did before it tried the next member first: the key for field i is compared with
+  // i + 1 member names, so an object with N members costs N (N + 1) / 2 compares instead of N.
+  // "schema" reads the in order records through a schema instead of serialize().
+  int bench_wide_objects(const std::string &variant)
+  {
+    const std::string json = make_wide_records_json(100000, variant == "reversed");
+    easy_serialize::EasySerializeStatus status;
+    double seconds = 0.0;
+    if (variant == "in_order" || variant == "reversed")
+    {
+      std::vector<WideRecord> records;
+      seconds = time_seconds([&]
+                             { status = easy_serialize::from_json_string_vector_objects(json, records); });
+    }
+    else if (variant == "find_member")
+    {
+      std::vector<WideRecord> records;
+      seconds = time_seconds([&]
+                             {
+                               rapidjson::Document d;
+                               d.Parse(json.data(), json.size());
+                               if (d.HasParseError() || !d.IsArray())
+                               {
+                                 status.set_error_message("find_member: bad document");
+                                 return;
+                               }
+                               records.clear();
+                               records.resize(d.Size());
+                               for (rapidjson::SizeType i = 0; i < d.Size() && status; ++i)
+                               {
+                                 for (size_t j = 0; j < WideRecord::num_fields; ++j)
+                                 {
+                                   const auto it = d[i].FindMember(WideRecord::key(j));
+                                   if (it == d[i].MemberEnd() || !it->value.IsInt64())
+                                   {
+                                     status.set_error_message("find_member: bad record");
+                                     break;
+                                   }
+                                   records[i].fields[j] = it->value.GetInt64();
+                                 }
+                               } });
+    }
+    else if (variant == "schema")
+    {
+      std::vector<FixedWideRecord> records;
+      seconds = time_seconds([&]
+                             { status = easy_serialize::from_json_string_vector_objects(json, records); });
+    }
+    else
+    {
+      return 2;
+    }
+    if (!status)
+    {
+      std::cerr << status.get_error_message() << "\n";
+      return 1;
+    }
+    report("wide_objects", variant.c_str(), json.size(), seconds);
+    return 0;
+  }
+
+  // Reads two members of each record in a large array: with the DOM reader, through serialize() or
+  // a schema ("schema"), the streaming reader, or the streaming reader skipping the other members
+  // ("projection").
+  int bench_projection(const std::string &variant)
+  {
+    const std::string json = make_records_json(1000000);
+    std::vector<RecordScore> scores;
+    easy_serialize::EasySerializeStatus status;
+    double seconds = 0.0;
+    if (variant == "dom")
+    {
+      seconds = time_seconds([&]
+                             { status = easy_serialize::from_json_string_vector_objects(json, scores); });
+    }
+    else if (variant == "schema")
+    {
+      std::vector<FixedRecordScore> fixed_scores;
+      seconds = time_seconds([&]
+                             { status = easy_serialize::from_json_string_vector_objects(json, fixed_scores); });
+    }
+    else if (variant == "streaming")
+    {
+      seconds = time_seconds([&]
+                             { status = easy_serialize::from_json_string_vector_objects_streaming(json, scores); });
+    }
+    else if (variant == "projection")
+    {
+      seconds = time_seconds([&]
+                             { status = easy_serialize::from_json_string_vector_objects_projection(json, scores); });
+    }
+    else
+    {
+      return 2;
+    }
+    if (!status)
+    {
+      std::cerr << status.get_error_message() << "\n";
+      return 1;
+    }
+    report("projection", variant.c_str(), json.size(), seconds);
+    return 0;
+  }
+
+  // Writes and reads an array of enums with many values.
+  int bench_enum_vector(const std::string &variant)
+  {
+    if (variant != "write" && variant != "read")
+    {
+      return 2;
+    }
+    std::vector<EventType> events(5000000);
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+      events[i] = static_cast<EventType>((i * 7919) % static_cast<size_t>(EventType::N));
+    }
+    std::string json;
+    const double write_seconds = time_seconds([&]
+                                              { json = easy_serialize::to_json_string_vector_enums(
+                                                    events, EventType::N, easy_serialize::JsonIndent::compact); });
+    if (variant == "write")
+    {
+      report("enum_vector", variant.c_str(), json.size(), write_seconds);
+      return 0;
+    }
+    std::vector<EventType> actual;
+    easy_serialize::EasySerializeStatus status;
+    const double seconds = time_seconds([&]
+                                        { status = easy_serialize::from_json_string_vector_enums(json, actual,
+                                                                                                 EventType::N); });
+    if (!status)
+    {
+      std::cerr << status.get_error_message() << "\n";
+      return 1;
+    }
+    report("enum_vector", variant.c_str(), json.size(), seconds);
+    return 0;
+  }
+
+  // Reads many messages that fail on a value nested in arrays and objects, as when validating
+  // untrusted input.
+  int bench_invalid_messages(const std::string &variant)
+  {
+    if (variant != "nested")
+    {
+      return 2;
+    }
+    const size_t num_messages = 1000000;
+    const std::string message = "[{\"id\":1,\"name\":\"a\",\"score\":1.5,\"active\":true,\"counts\":[1,2,3]},"
+                                "{\"id\":2,\"name\":\"b\",\"score\":2.5,\"active\":false,\"counts\":[4,5,\"6\"]}]";
+    std::vector<Record> records;
+    easy_serialize::JsonReaderContext context;
+    size_t num_failed = 0;
+    const double seconds = time_seconds([&]
+                                        {
+                                          for (size_t i = 0; i < num_messages; ++i)
+                                          {
+                                            if (!easy_serialize::from_json_string_vector_objects(message, records, context))
+                                            {
+                                              ++num_failed;
+                                            }
+                                          } });
+    if (num_failed != num_messages)
+    {
+      std::cerr << "expected every message to fail\n";
+      return 1;
+    }
+    report("invalid_messages", variant.c_str(), message.size() * num_messages, seconds);
+    return 0;
+  }
+
+  // Reads a 10M element array of doubles: as the whole document ("top_level"), or as an object
+  // member with the DOM reader ("dom") or the streaming reader ("streaming"). The top level and
+  // streaming reads scan the numbers straight from the bytes.
+  int bench_numeric_array(const std::string &variant)
+  {
+    const std::string array = make_doubles_json(10000000);
+    easy_serialize::EasySerializeStatus status;
+    double seconds = 0.0;
+    size_t num_values = 0;
+    if (variant == "top_level")
+    {
+      std::vector<double> values;
+      seconds = time_seconds([&]
+                             { status = easy_serialize::from_json_string_vector(array, values); });
+      num_values = values.size();
+    }
+    else if (variant == "dom" || variant == "streaming")
+    {
+      const std::string json = "{\"values\":" + array + "}";
+      Samples samples;
+      seconds = time_seconds([&]
+                             { status = variant == "dom" ? easy_serialize::from_json_string(json, samples)
+                                                         : easy_serialize::from_json_string_streaming(json, samples); });
+      num_values = samples.values.size();
+    }
+    else
+    {
+      return 2;
+    }
+    if (!status || num_values != 10000000)
+    {
+      std::cerr << status.get_error_message() << "\n";
+      return 1;
+    }
+    report("numeric_array", variant.c_str(), array.size(), seconds);
+    return 0;
+  }
+
+  // Writes a 10M element array of doubles like telemetry readings (full precision, not round
+  // numbers), compact, with easy_serialize ("shortest", shortest round trip) or with rapidjson's
+  // Writer::Double ("rapidjson") for comparison. Both read back to the same values.
+  int bench_write_doubles(const std::string &variant)
+  {
+    if (variant != "shortest" && variant != "rapidjson")
+    {
+      return 2;
+    }
+    std::vector<double> values(10000000);
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+      values[i] = std::sin(static_cast<double>(i)) * 1000.0 + static_cast<double>(i % 977) / 7.0;
+    }
+    std::string json;
+    double seconds = 0.0;
+    if (variant == "shortest")
+    {
+      seconds = time_seconds([&]
+                             { easy_serialize::to_json_string_vector(values, json, easy_serialize::JsonIndent::compact); });
+    }
+    else
+    {
+      seconds = time_seconds([&]
+                             {
+                               rapidjson::StringBuffer string_buffer;
+                               rapidjson::Writer<rapidjson::StringBuffer> writer(string_buffer);
+                               writer.StartArray();
+                               for (const double d : values)
+                               {
+                                 writer.Double(d);
+                               }
+                               writer.EndArray();
+                               json.assign(string_buffer.GetString(), string_buffer.GetSize()); });
+    }
+    std::vector<double> actual;
+    const auto status = easy_serialize::from_json_string_vector(json, actual);
+    if (!status || actual != values)
+    {
+      std::cerr << "values don't read back: " << status.get_error_message() << "\n";
+      return 1;
+    }
+    report("write_doubles", variant.c_str(), json.size(), seconds);
+    return 0;
+  }
+
+  // Writes 1M messages into a reused std::string with the rapidjson writer archive or the native
+  // one, compact or indented ("rapidjson", "native", "rapidjson_indented", "native_indented").
+  // Both write the same bytes.
+  int bench_write_archives(const std::string &variant)
+  {
+    const bool native = variant == "native" || variant == "native_indented";
+    if (!native && variant != "rapidjson" && variant != "rapidjson_indented")
+    {
+      return 2;
+    }
+    const auto json_indent = variant == "rapidjson" || variant == "native"
+                                 ? easy_serialize::JsonIndent::compact
+                                 : easy_serialize::JsonIndent::two_spaces;
+    const size_t num_messages = 1000000;
+    Record record;
+    record.id = 123456789;
+    record.name = "record number \"123456789\"";
+    record.score = 87.25;
+    record.active = true;
+    record.counts = {3, 5, 7, 11};
+    std::string send_buffer;
+    auto write = [&]()
+    {
+      send_buffer.clear();
+      if (native)
+      {
+        easy_serialize::native_impl::to_json_string(record, send_buffer, json_indent);
+      }
+      else
+      {
+        easy_serialize::StringOutputStream os(send_buffer);
+        easy_serialize::rapidjson_impl::to_json_stream(os, record, json_indent);
+      }
+    };
+    std::string expected;
+    easy_serialize::StringOutputStream expected_os(expected);
+    easy_serialize::rapidjson_impl::to_json_stream(expected_os, record, json_indent);
+    write();
+    if (send_buffer != expected)
+    {
+      std::cerr << "JSON differs from rapidjson's: " << send_buffer << "\n";
+      return 1;
+    }
+    size_t bytes = 0;
+    const double seconds = time_seconds([&]
+                                        {
+                                          for (size_t i = 0; i < num_messages; ++i)
+                                          {
+                                            write();
+                                            bytes += send_buffer.size();
+                                          } });
+    report("write_archives", variant.c_str(), bytes, seconds);
+    return 0;
+  }
+
+  // Reads 2M lines of JSON Lines on one thread ("serial") or on a thread per core ("parallel").
+  int bench_json_lines(const std::string &variant)
+  {
+    const size_t num_records = 2000000;
+    const std::string json = make_records_json_lines(num_records);
+    size_t num_read = 0;
+    auto callback = [&num_read](size_t /*line_number*/, const easy_serialize::EasySerializeStatus &status,
+                                Record & /*record*/)
+    {
+      num_read += status ? 1 : 0;
+      return true;
+    };
+    double seconds = 0.0;
+    if (variant == "serial")
+    {
+      seconds = time_seconds([&]
+                             { easy_serialize::for_each_json_line<Record>(json, callback); });
+    }
+    else if (variant == "parallel")
+    {
+      seconds = time_seconds([&]
+                             { easy_serialize::for_each_json_line_parallel<Record>(json, callback); });
+    }
+    else
+    {
+      return 2;
+    }
+    if (num_read != num_records)
+    {
+      std::cerr << "read " << num_read << " of " << num_records << " records\n";
+      return 1;
+    }
+    report("json_lines", variant.c_str(), json.size(), seconds);
+    return 0;
+  }
+
+  // Feeds message to reader num_messages times, in fragments of fragment_size bytes.
+  template <typename T>
+  easy_serialize::EasySerializeStatus push_messages(easy_serialize::JsonPushReader<T> &reader, T &obj,
+                                                    const std::string &message, size_t num_messages,
+                                                    size_t fragment_size)
+  {
+    easy_serialize::EasySerializeStatus status;
+    for (size_t i = 0; i < num_messages && status; ++i)
+    {
+      reader.reset(obj);
+      for (size_t pos = 0; pos < message.size(); pos += fragment_size)
+      {
+        reader.feed(message.data() + pos, std::min(fragment_size, message.size() - pos));
+      }
+      status = reader.finish();
+    }
+    return status;
+  }
+
+  // Reads many small messages with the streaming reader from one buffer each, or with one
+  // JsonPushReader reset for each message and fed it whole ("push") or in 16 byte fragments, to
+  // show what finding the token boundaries and carrying split tokens costs. The "schema" variants
+  // read a type with a schema, which the push reader binds a member at a time instead of building
+  // a DOM.
+  int bench_push_messages(const std::string &variant)
+  {
+    const size_t num_messages = 200000;
+    const std::string json = make_records_json(1).substr(1);
+    const std::string message = json.substr(0, json.size() - 1);
+    const size_t fragment_size = variant.size() > 3 && variant.compare(variant.size() - 3, 3, "_16") == 0
+                                     ? 16
+                                     : message.size();
+    Record record;
+    FixedRecord fixed_record;
+    easy_serialize::EasySerializeStatus status;
+    double seconds = 0.0;
+    if (variant == "streaming")
+    {
+      seconds = time_seconds([&]
+                             {
+                               for (size_t i = 0; i < num_messages && status; ++i)
+                               {
+                                 status = easy_serialize::from_json_string_streaming(message, record);
+                               } });
+    }
+    else if (variant == "push" || variant == "push_16")
+    {
+      easy_serialize::JsonPushReader<Record> reader(record);
+      seconds = time_seconds([&]
+                             { status = push_messages(reader, record, message, num_messages, fragment_size); });
+    }
+    else if (variant == "push_schema" || variant == "push_schema_16")
+    {
+      easy_serialize::JsonPushReader<FixedRecord> reader(fixed_record);
+      seconds = time_seconds([&]
+                             { status = push_messages(reader, fixed_record, message, num_messages, fragment_size); });
+    }
+    else
+    {
+      return 2;
+    }
+    if (!status)
+    {
+      std::cerr << status.get_error_message() << "\n";
+      return 1;
+    }
+    report("push_messages", variant.c_str(), message.size() * num_messages, seconds);
+    return 0;
+  }
+
+  struct Benchmark
+  {
+    const char *name;
+    int (*fn)(const std::string &variant);
+  };
+
+  const Benchmark benchmarks[] = {
+      {"large_document", bench_large_document},
+      {"small_messages", bench_small_messages},
+      {"write_messages", bench_write_messages},
+      {"wide_objects", bench_wide_objects},
+      {"projection", bench_projection},
+      {"enum_vector", bench_enum_vector},
+      {"invalid_messages", bench_invalid_messages},
+      {"numeric_array", bench_numeric_array},
+      {"write_doubles", bench_write_doubles},
+      {"write_archives", bench_write_archives},
+      {"json_lines", bench_json_lines},
+      {"push_messages", bench_push_messages},
+  };
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc == 3)
+  {
+    for (const auto &benchmark : benchmarks)
+    {
+      if (std::strcmp(argv[1], benchmark.name) == 0)
+      {
+        const int result = benchmark.fn(argv[2]);
+        if (result != 2)
+        {
+          return result;
+        }
+      }
+    }
+  }
+  std::cerr << "usage: " << argv[0] << " <benchmark> <variant>\n";
+  return 2;
+}
@@ -0,0 +1,45 @@
+// easy_serialize compile-time configuration.
+#pragma once
+
+// std::string_view members are supported from C++17.
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define EASY_SERIALIZE_HAS_STRING_VIEW 1
+#include <string_view>
+#else
+#define EASY_SERIALIZE_HAS_STRING_VIEW 0
+#endif
+
+// Files are read with mmap() on POSIX systems.
+#if defined(__unix__) || defined(__APPLE__)
+#define EASY_SERIALIZE_HAS_MMAP 1
+#else
+#define EASY_SERIALIZE_HAS_MMAP 0
+#endif
+
+// Files are written to a temporary file made with mkstemp(), fsync()ed and renamed over the old
+// one, and the directory fsync()ed, on POSIX systems. Elsewhere the temporary file is
+// "<filename>.tmp" and the old file is removed before the rename.
+#if defined(__unix__) || defined(__APPLE__)
+#define EASY_SERIALIZE_HAS_ATOMIC_RENAME 1
+#else
+#define EASY_SERIALIZE_HAS_ATOMIC_RENAME 0
+#endif
+
+// Doubles are written with std::to_chars (shortest round trip) where the standard library has it.
+#if EASY_SERIALIZE_HAS_STRING_VIEW && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define EASY_SERIALIZE_HAS_TO_CHARS 1
+#else
+#define EASY_SERIALIZE_HAS_TO_CHARS 0
+#endif
+
+// Define EASY_SERIALIZE_NATIVE_WRITER=1 to write JSON strings (to_json_string() and the like) with
+// native_impl::JsonWriterArchive instead of rapidjson. The JSON is the same, byte for byte.
+// Output streams and files are always written with rapidjson.
+#ifndef EASY_SERIALIZE_NATIVE_WRITER
+#define EASY_SERIALIZE_NATIVE_WRITER 0
+#endif
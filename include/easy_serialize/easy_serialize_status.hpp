@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace easy_serialize
 {
@@ -19,9 +21,56 @@ namespace easy_serialize
     {
         std::string _error_message{""};
 
+        // Reader errors keep the reason and the keys/indexes to the failing value, innermost
+        // first, and only build the message when it is asked for.
+        struct PathElement
+        {
+            std::string key;
+            size_t index;
+            bool is_index;
+        };
+        const char *_error_reason = nullptr;
+        std::vector<PathElement> _error_path;
+
     public:
-        operator bool() const noexcept { return _error_message.empty(); }
-        std::string get_error_message() const noexcept { return _error_message; }
-        void set_error_message(std::string error_message) { _error_message = error_message; }
+        operator bool() const noexcept { return _error_message.empty() && !_error_reason; }
+        std::string get_error_message() const noexcept
+        {
+            if (!_error_reason)
+            {
+                return _error_message;
+            }
+            std::string error_message;
+            for (auto it = _error_path.rbegin(); it != _error_path.rend(); ++it)
+            {
+                if (it->is_index)
+                {
+                    error_message += "[" + std::to_string(it->index) + "]";
+                }
+                else
+                {
+                    error_message += "[\"" + it->key + "\"]";
+                }
+            }
+            return error_message + _error_reason;
+        }
+        void set_error_message(std::string error_message)
+        {
+            _error_message = error_message;
+            _error_reason = nullptr;
+            _error_path.clear();
+        }
+
+        // Set a reader error. reason must be a string literal (it isn't copied).
+        void set_error_reason(const char *reason)
+        {
+            _error_message.clear();
+            _error_reason = reason;
+            _error_path.clear();
+        }
+        // Add the key of the object member containing the error, working outwards.
+        void add_error_key(const char *key) { _error_path.push_back({key, 0, false}); }
+        // Add the index of the array element containing the error, working outwards.
+        void add_error_index(size_t index) { _error_path.push_back({std::string(), index, true}); }
     };
 }
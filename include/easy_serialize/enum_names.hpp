@@ -0,0 +1,124 @@
+// easy_serialize enum name lookup tables.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace easy_serialize
+{
+    // Names of an enum's values, from the client's to_string() function, with a hash table to
+    // look values up by name. Built once per enum type and enum_value_N (see get_enum_names()).
+    //
+    // The enum integer values must be contiguous from 0 to < enum_value_N.
+    template <typename T>
+    class EnumNames
+    {
+    public:
+        explicit EnumNames(T enum_value_N)
+        {
+            const int n = static_cast<int>(enum_value_N);
+            _names.reserve(static_cast<size_t>(n));
+            _lengths.reserve(static_cast<size_t>(n));
+            size_t table_size = 1;
+            while (table_size < 2 * static_cast<size_t>(n))
+            {
+                table_size *= 2;
+            }
+            _table.assign(table_size, -1);
+            for (int i = 0; i < n; ++i)
+            {
+                const char *name = to_string(static_cast<T>(i));
+                _names.push_back(name);
+                _lengths.push_back(std::strlen(name));
+                // Keep the first value if two have the same name, as a scan from 0 would.
+                T existing;
+                if (!find(name, _lengths.back(), existing))
+                {
+                    size_t slot = hash(name, _lengths.back()) & (_table.size() - 1);
+                    while (_table[slot] >= 0)
+                    {
+                        slot = (slot + 1) & (_table.size() - 1);
+                    }
+                    _table[slot] = i;
+                }
+            }
+        }
+
+        // Number of values with names (enum_value_N).
+        size_t size() const { return _names.size(); }
+
+        // Name of value, which must be < enum_value_N.
+        const char *name(T e) const { return _names[static_cast<size_t>(e)]; }
+
+        // Length of the name of value, which must be < enum_value_N.
+        size_t length(T e) const { return _lengths[static_cast<size_t>(e)]; }
+
+        // Look up a value by name.
+        //
+        // \param name: name (doesn't need a null terminator)
+        // \param length: length of name
+        // \param e: set to the value if found
+        // \return: true if found
+        bool find(const char *name, size_t length, T &e) const
+        {
+            size_t slot = hash(name, length) & (_table.size() - 1);
+            while (_table[slot] >= 0)
+            {
+                const size_t i = static_cast<size_t>(_table[slot]);
+                if (_lengths[i] == length && std::memcmp(_names[i], name, length) == 0)
+                {
+                    e = static_cast<T>(i);
+                    return true;
+                }
+                slot = (slot + 1) & (_table.size() - 1);
+            }
+            return false;
+        }
+
+    private:
+        // FNV-1a
+        static size_t hash(const char *s, size_t length)
+        {
+            uint64_t h = 14695981039346656037ull;
+            for (size_t i = 0; i < length; ++i)
+            {
+                h ^= static_cast<unsigned char>(s[i]);
+                h *= 1099511628211ull;
+            }
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+
+        std::vector<const char *> _names;
+        std::vector<size_t> _lengths;
+        // Open addressing hash table of value indexes, -1 for empty slots.
+        std::vector<int> _table;
+    };
+
+    // Get the names of an enum type's values, building them on the first call for each
+    // enum_value_N. Calls with the enum_value_N of the first call don't take a lock.
+    //
+    // \param enum_value_N: last enum value (not a valid value)
+    // \return: names, shared by all calls for enum type T and enum_value_N
+    template <typename T>
+    const EnumNames<T> &get_enum_names(T enum_value_N)
+    {
+        static const EnumNames<T> first(enum_value_N);
+        if (first.size() == static_cast<size_t>(enum_value_N))
+        {
+            return first;
+        }
+        static std::mutex mutex;
+        static std::map<int, std::unique_ptr<const EnumNames<T>>> others;
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unique_ptr<const EnumNames<T>> &names = others[static_cast<int>(enum_value_N)];
+        if (!names)
+        {
+            names.reset(new EnumNames<T>(enum_value_N));
+        }
+        return *names;
+    }
+} // namespace easy_serialize
@@ -1,41 +1,128 @@
 // easy_serialize JSON helper functions for reading from a file.
 #pragma once
 
+#include "easy_serialize_config.hpp"
 #include "json_reader.hpp"
+
 #include <cstdio>
+#include <string>
+#include <vector>
+
+#if EASY_SERIALIZE_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace easy_serialize
 {
-    namespace // unnamed
+    // Contents of a file, for reading JSON from.
+    //
+    // Regular files are memory mapped (where mmap() is available), so the JSON is parsed straight
+    // from the page cache without copying it first. Anything that can't be mapped (pipes, special
+    // files, other platforms) is read into memory.
+    class JsonFileContents
     {
-        // Helper function for reading json from a file.
-        EasySerializeStatus from_file(const std::string &filename, std::string &json)
+    public:
+        explicit JsonFileContents(const std::string &filename)
         {
-            EasySerializeStatus status;
-            std::FILE *fp = fopen(filename.c_str(), "r");
-            if (!fp)
+#if EASY_SERIALIZE_HAS_MMAP
+            const int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
             {
-                status.set_error_message("File opening failed.");
+                _status.set_error_message("File opening failed.");
+                return;
             }
-            else
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
             {
-                fseek(fp, 0L, SEEK_END);
-                const auto sz = ftell(fp);
-                if (sz < 0)
+                const size_t size = static_cast<size_t>(st.st_size);
+                void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED)
                 {
-                    status.set_error_message("File reading error. Too big?");
+                    // The parser reads front to back, so read ahead aggressively.
+                    ::madvise(mapping, size, MADV_SEQUENTIAL);
+                    _mapping = mapping;
+                    _data = static_cast<const char *>(mapping);
+                    _size = size;
+                    ::close(fd);
+                    return;
                 }
-                else
+            }
+            std::FILE *fp = ::fdopen(fd, "rb");
+            if (!fp)
+            {
+                ::close(fd);
+                _status.set_error_message("File opening failed.");
+                return;
+            }
+#else
+            std::FILE *fp = std::fopen(filename.c_str(), "rb");
+            if (!fp)
+            {
+                _status.set_error_message("File opening failed.");
+                return;
+            }
+#endif
+            read(fp);
+            std::fclose(fp);
+        }
+        ~JsonFileContents()
+        {
+#if EASY_SERIALIZE_HAS_MMAP
+            if (_mapping)
+            {
+                ::munmap(_mapping, _size);
+            }
+#endif
+        }
+        JsonFileContents(const JsonFileContents &) = delete;
+        JsonFileContents &operator=(const JsonFileContents &) = delete;
+
+        // Error if the file couldn't be opened or read.
+        const EasySerializeStatus &status() const { return _status; }
+        const char *data() const { return _data; }
+        size_t size() const { return _size; }
+
+    private:
+        // Read fp to the end, however many reads that takes.
+        void read(std::FILE *fp)
+        {
+            const size_t chunk_size = 64 * 1024;
+            size_t size = 0;
+            for (;;)
+            {
+                _buffer.resize(size + chunk_size);
+                const size_t bytes_read = std::fread(&_buffer[size], 1, chunk_size, fp);
+                size += bytes_read;
+                if (bytes_read < chunk_size)
                 {
-                    std::rewind(fp);
-                    json.resize(static_cast<size_t>(sz));
-                    std::ignore = std::fread(&json[0], sizeof(json[0]), json.size(), fp);
+                    if (std::ferror(fp))
+                    {
+                        _status.set_error_message("File reading error.");
+                    }
+                    else if (!std::feof(fp))
+                    {
+                        continue;
+                    }
+                    break;
                 }
-                fclose(fp);
             }
-            return status;
+            _buffer.resize(size);
+            if (size > 0)
+            {
+                _data = _buffer.data();
+                _size = size;
+            }
         }
-    } // unnamed namespace
+
+        EasySerializeStatus _status;
+        const char *_data = "";
+        size_t _size = 0;
+        void *_mapping = nullptr;
+        std::vector<char> _buffer;
+    };
 
     // Populate an object from a UTF-8 JSON file.
     //
@@ -45,13 +132,12 @@ namespace easy_serialize
     template <typename T>
     EasySerializeStatus from_json_file(const std::string &filename, T &obj)
     {
-        std::string json;
-        EasySerializeStatus status = from_file(filename, json);
-        if (!status)
+        const JsonFileContents file(filename);
+        if (!file.status())
         {
-            return status;
+            return file.status();
         }
-        return from_json_string(json, obj);
+        return rapidjson_impl::from_json_buffer(file.data(), file.size(), obj);
     }
 
     // Populate a vector of objects from a UTF-8 JSON file.
@@ -62,13 +148,12 @@ namespace easy_serialize
     template <typename T>
     EasySerializeStatus from_json_file_vector_objects(const std::string &filename, std::vector<T> &v)
     {
-        std::string json;
-        EasySerializeStatus status = from_file(filename, json);
-        if (!status)
+        const JsonFileContents file(filename);
+        if (!file.status())
         {
-            return status;
+            return file.status();
         }
-        return from_json_string_vector_objects(json, v);
+        return rapidjson_impl::from_json_buffer_vector_objects(file.data(), file.size(), v);
     }
 
     // Populate a vector of primitive types from a UTF-8 JSON file.
@@ -79,13 +164,12 @@ namespace easy_serialize
     template <typename T>
     EasySerializeStatus from_json_file_vector(const std::string &filename, std::vector<T> &v)
     {
-        std::string json;
-        EasySerializeStatus status = from_file(filename, json);
-        if (!status)
+        const JsonFileContents file(filename);
+        if (!file.status())
         {
-            return status;
+            return file.status();
         }
-        return from_json_string_vector(json, v);
+        return rapidjson_impl::from_json_buffer_vector(file.data(), file.size(), v);
     }
 
     // Populate a vector of enums from a UTF-8 JSON file.
@@ -103,13 +187,90 @@ namespace easy_serialize
     EasySerializeStatus from_json_file_vector_enums(const std::string &filename, std::vector<T> &v,
                                                     T enum_value_N)
     {
-        std::string json;
-        EasySerializeStatus status = from_file(filename, json);
-        if (!status)
+        const JsonFileContents file(filename);
+        if (!file.status())
         {
-            return status;
+            return file.status();
         }
-        return from_json_string_vector_enums(json, v, enum_value_N);
+        return rapidjson_impl::from_json_buffer_vector_enums(file.data(), file.size(), v, enum_value_N);
+    }
+
+    // Populate an object from a UTF-8 JSON file, streaming the file through a fixed-size buffer
+    // and binding values as they are parsed. Memory use doesn't depend on the size of the file.
+    // Same results and errors as from_json_file.
+    //
+    // \param filename: name of file
+    // \param obj: object to populate
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_file_streaming(const std::string &filename, T &obj)
+    {
+        return rapidjson_impl::read_json_file_stream(
+            filename, [&obj](auto &is)
+            { return rapidjson_impl::from_json_stream(is, obj); });
+    }
+
+    // Populate a vector of objects from a UTF-8 JSON file, streaming the file through a
+    // fixed-size buffer. See for_each_json_file_object() to avoid holding all the objects.
+    //
+    // \param filename: name of file
+    // \param v: vector of objects to populate
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_file_vector_objects_streaming(const std::string &filename, std::vector<T> &v)
+    {
+        return rapidjson_impl::read_json_file_stream(
+            filename, [&v](auto &is)
+            { return rapidjson_impl::from_json_stream_vector_objects(is, v); });
+    }
+
+    // Populate a vector of primitive types from a UTF-8 JSON file, streaming the file through a
+    // fixed-size buffer.
+    //
+    // \param filename: name of file
+    // \param v: vector to populate
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_file_vector_streaming(const std::string &filename, std::vector<T> &v)
+    {
+        return rapidjson_impl::read_json_file_stream(
+            filename, [&v](auto &is)
+            { return rapidjson_impl::from_json_stream_vector(is, v); });
+    }
+
+    // Populate a vector of enums from a UTF-8 JSON file, streaming the file through a fixed-size
+    // buffer.
+    //
+    // \param filename: name of file
+    // \param v: vector to populate
+    // \param enum_value_N: last enum value (not a valid value)
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_file_vector_enums_streaming(const std::string &filename, std::vector<T> &v,
+                                                              T enum_value_N)
+    {
+        return rapidjson_impl::read_json_file_stream(
+            filename, [&v, enum_value_N](auto &is)
+            { return rapidjson_impl::from_json_stream_vector_enums(is, v, enum_value_N); });
+    }
+
+    // Read a UTF-8 JSON file holding an array of objects one object at a time, calling callback
+    // for each. The file is streamed through a fixed-size buffer and only one object is in memory
+    // at a time, so files bigger than memory can be read.
+    //
+    // The callback is called as bool callback(size_t index, T &obj). Return true to carry on, false
+    // to stop (the rest of the file isn't read). On an error, the objects before the failing one
+    // have already been passed to the callback, and the error message has the failing index.
+    //
+    // \param filename: name of file
+    // \param callback: called for each object
+    // \return: EasySerializeStatus object
+    template <typename T, typename Callback>
+    EasySerializeStatus for_each_json_file_object(const std::string &filename, Callback callback)
+    {
+        return rapidjson_impl::read_json_file_stream(
+            filename, [&callback](auto &is)
+            { return rapidjson_impl::for_each_json_stream_object<T>(is, callback); });
     }
 
 } // namespace easy_serialize
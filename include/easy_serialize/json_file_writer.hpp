@@ -1,43 +1,237 @@
 // easy_serialize JSON helper functions for writing to a file.
 #pragma once
 
+#include "easy_serialize_config.hpp"
 #include "easy_serialize_status.hpp"
 #include "json_writer.hpp"
 
+#include <cstddef>
 #include <cstdio>
+#include <string>
+#include <vector>
+
+#if EASY_SERIALIZE_HAS_ATOMIC_RENAME
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace easy_serialize
 {
+    // How the to_json_file functions write the file.
+    enum class JsonFileWrite
+    {
+        // Write over the file. After an error it holds part of the JSON.
+        overwrite,
+        // Write a temporary file next to the file and rename it over the file once it's all
+        // written, so the file holds either the old JSON or the new JSON. On POSIX systems the
+        // temporary file has a unique name ("<filename>.XXXXXX"), so concurrent writers don't
+        // share it, and it is synced to disk before the rename and the directory after it, so
+        // the new JSON survives a crash. Elsewhere it is "<filename>.tmp".
+        atomic,
+    };
 
-    // Helper function for writing json to a file.
-    EasySerializeStatus to_file(const std::string &filename, const std::string &json)
+    namespace rapidjson_impl
     {
-        EasySerializeStatus status;
-        std::FILE *fp = fopen(filename.c_str(), "w");
-        if (!fp)
+        // rapidjson output stream writing to a file through a fixed-size buffer, so memory use
+        // doesn't depend on the size of the JSON. Every write is checked; after a failed one
+        // nothing more is written and failed() is set.
+        class FileOutputStream
         {
-            status.set_error_message("File opening failed.");
+        public:
+            typedef char Ch;
+
+            FileOutputStream(std::FILE *fp, size_t buffer_size) : _fp(fp), _buffer(buffer_size) {}
+            FileOutputStream(const FileOutputStream &) = delete;
+            FileOutputStream &operator=(const FileOutputStream &) = delete;
+
+            void Put(Ch c)
+            {
+                if (_size == _buffer.size())
+                {
+                    Flush();
+                }
+                _buffer[_size++] = c;
+            }
+            void Flush()
+            {
+                if (_size > 0 && !_failed && std::fwrite(_buffer.data(), 1, _size, _fp) != _size)
+                {
+                    _failed = true;
+                }
+                _size = 0;
+            }
+
+            bool failed() const { return _failed; }
+
+        private:
+            std::FILE *_fp;
+            std::vector<char> _buffer;
+            size_t _size = 0;
+            bool _failed = false;
+        };
+
+#if EASY_SERIALIZE_HAS_ATOMIC_RENAME
+        // Create a uniquely named file in the same directory as filename, to be renamed over it.
+        // It gets the permissions of the file it replaces, or 0644 for a new file (mkstemp()
+        // would make it 0600).
+        //
+        // \param filename: name of file to replace
+        // \param path: set to the name of the temporary file
+        // \return: temporary file open for writing, or nullptr if it couldn't be made
+        inline std::FILE *open_temporary_file(const std::string &filename, std::string &path)
+        {
+            std::vector<char> name(filename.begin(), filename.end());
+            const char suffix[] = ".XXXXXX";
+            name.insert(name.end(), suffix, suffix + sizeof(suffix));
+            const int fd = ::mkstemp(name.data());
+            if (fd < 0)
+            {
+                return nullptr;
+            }
+            path = name.data();
+            struct stat file_stat;
+            const mode_t mode = ::stat(filename.c_str(), &file_stat) == 0 ? file_stat.st_mode & 07777 : 0644;
+            std::FILE *fp = ::fchmod(fd, mode) == 0 ? ::fdopen(fd, "wb") : nullptr;
+            if (!fp)
+            {
+                ::close(fd);
+                std::remove(path.c_str());
+            }
+            return fp;
+        }
+
+        // Sync the directory holding filename to disk, so a rename in it survives a crash.
+        //
+        // \return: false on error
+        inline bool sync_directory(const std::string &filename)
+        {
+            const size_t slash = filename.rfind('/');
+            const std::string directory = slash == std::string::npos ? "." : filename.substr(0, slash + 1);
+            const int fd = ::open(directory.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                return false;
+            }
+            const bool synced = ::fsync(fd) == 0;
+            return ::close(fd) == 0 && synced;
         }
-        else
+#endif
+
+        // Write a file through a FileOutputStream, checking every step.
+        //
+        // \param filename: name of file
+        // \param write: function writing the JSON to a FileOutputStream
+        // \param file_write: how to write the file
+        // \param buffer_size: bytes to write to the file at a time
+        // \return: status, with an error if the file couldn't be opened, written or renamed
+        template <typename Write>
+        EasySerializeStatus write_json_file_stream(const std::string &filename, Write write,
+                                                   JsonFileWrite file_write, size_t buffer_size = 64 * 1024)
         {
-            std::fwrite(json.c_str(), json.size(), 1, fp);
-            fclose(fp);
+            EasySerializeStatus status;
+            const bool atomic = file_write == JsonFileWrite::atomic;
+            std::string path = filename;
+            std::FILE *fp = nullptr;
+            if (!atomic)
+            {
+                fp = std::fopen(path.c_str(), "wb");
+            }
+            else
+            {
+#if EASY_SERIALIZE_HAS_ATOMIC_RENAME
+                fp = open_temporary_file(filename, path);
+#else
+                path = filename + ".tmp";
+                fp = std::fopen(path.c_str(), "wb");
+#endif
+            }
+            if (!fp)
+            {
+                status.set_error_message("File opening failed.");
+                return status;
+            }
+            // The stream does the buffering.
+            std::setvbuf(fp, nullptr, _IONBF, 0);
+            bool written = false;
+            {
+                FileOutputStream os(fp, buffer_size);
+                write(os);
+                os.Flush();
+                written = !os.failed();
+            }
+            written = std::fflush(fp) == 0 && written;
+#if EASY_SERIALIZE_HAS_ATOMIC_RENAME
+            if (atomic && written)
+            {
+                written = ::fsync(::fileno(fp)) == 0;
+            }
+#endif
+            written = std::fclose(fp) == 0 && written;
+            if (!written)
+            {
+                status.set_error_message("File writing error.");
+                if (atomic)
+                {
+                    std::remove(path.c_str());
+                }
+                return status;
+            }
+            if (atomic)
+            {
+#if !EASY_SERIALIZE_HAS_ATOMIC_RENAME
+                // rename() doesn't replace an existing file here.
+                std::remove(filename.c_str());
+#endif
+                if (std::rename(path.c_str(), filename.c_str()) != 0)
+                {
+                    std::remove(path.c_str());
+                    status.set_error_message("File renaming failed.");
+                }
+#if EASY_SERIALIZE_HAS_ATOMIC_RENAME
+                else if (!sync_directory(filename))
+                {
+                    // The file holds the new JSON, but the rename may not survive a crash.
+                    status.set_error_message("Directory syncing failed.");
+                }
+#endif
+            }
+            return status;
         }
-        return status;
+    } // namespace rapidjson_impl
+
+    // Helper function for writing json to a file.
+    inline EasySerializeStatus to_file(const std::string &filename, const std::string &json,
+                                       JsonFileWrite file_write = JsonFileWrite::overwrite)
+    {
+        return rapidjson_impl::write_json_file_stream(
+            filename, [&json](rapidjson_impl::FileOutputStream &os)
+            {
+                for (const char c : json)
+                {
+                    os.Put(c);
+                } },
+            file_write);
     }
 
-    // Write object UTF-8 JSON to file.
+    // Write object UTF-8 JSON to file. The JSON is written through a fixed-size buffer as it's
+    // made, so it is never held in memory.
     //
     // \param filename: "path/to/filename.json"
     // \param obj: object to write
     // \param json_indent: JSON indent formatting
+    // \param file_write: how to write the file
     // \return status
     template <typename T>
     EasySerializeStatus to_json_file(const std::string &filename, T &obj,
-                                     JsonIndent json_indent = JsonIndent::two_spaces)
+                                     JsonIndent json_indent = JsonIndent::two_spaces,
+                                     JsonFileWrite file_write = JsonFileWrite::overwrite)
     {
-        std::string json = to_json_string(obj, json_indent);
-        return to_file(filename, json);
+        return rapidjson_impl::write_json_file_stream(
+            filename, [&obj, json_indent](rapidjson_impl::FileOutputStream &os)
+            { rapidjson_impl::to_json_stream(os, obj, json_indent); },
+            file_write);
     }
 
     // Write vector of objects UTF-8 JSON to a file.
@@ -45,13 +239,17 @@ namespace easy_serialize
     // \param filename: "path/to/filename.json"
     // \param v: vector of objects to write
     // \param json_indent: JSON indent formatting
+    // \param file_write: how to write the file
     // \return status
     template <typename T>
     EasySerializeStatus to_json_file_vector_objects(const std::string &filename, std::vector<T> &v,
-                                                    JsonIndent json_indent = JsonIndent::two_spaces)
+                                                    JsonIndent json_indent = JsonIndent::two_spaces,
+                                                    JsonFileWrite file_write = JsonFileWrite::overwrite)
     {
-        std::string json = to_json_string_vector_objects(v, json_indent);
-        return to_file(filename, json);
+        return rapidjson_impl::write_json_file_stream(
+            filename, [&v, json_indent](rapidjson_impl::FileOutputStream &os)
+            { rapidjson_impl::to_json_stream_vector_objects(os, v, json_indent); },
+            file_write);
     }
 
     // Write vector of enums UTF-8 JSON to a file.
@@ -59,13 +257,36 @@ namespace easy_serialize
     // \param filename: "path/to/filename.json"
     // \param v: vector of enums to write
     // \param json_indent: JSON indent formatting
+    // \param file_write: how to write the file
     // \return status
     template <typename T>
     EasySerializeStatus to_json_file_vector_enums(const std::string &filename, std::vector<T> &v,
-                                                  JsonIndent json_indent = JsonIndent::two_spaces)
+                                                  JsonIndent json_indent = JsonIndent::two_spaces,
+                                                  JsonFileWrite file_write = JsonFileWrite::overwrite)
+    {
+        return rapidjson_impl::write_json_file_stream(
+            filename, [&v, json_indent](rapidjson_impl::FileOutputStream &os)
+            { rapidjson_impl::to_json_stream_vector_enums(os, v, json_indent); },
+            file_write);
+    }
+
+    // Write vector of enums UTF-8 JSON to a file, using the enum's cached names.
+    //
+    // \param filename: "path/to/filename.json"
+    // \param v: vector of enums to write
+    // \param enum_value_N: last enum value (not a valid value)
+    // \param json_indent: JSON indent formatting
+    // \param file_write: how to write the file
+    // \return status
+    template <typename T>
+    EasySerializeStatus to_json_file_vector_enums(const std::string &filename, std::vector<T> &v, T enum_value_N,
+                                                  JsonIndent json_indent = JsonIndent::two_spaces,
+                                                  JsonFileWrite file_write = JsonFileWrite::overwrite)
     {
-        std::string json = to_json_string_vector_enums(v, json_indent);
-        return to_file(filename, json);
+        return rapidjson_impl::write_json_file_stream(
+            filename, [&v, enum_value_N, json_indent](rapidjson_impl::FileOutputStream &os)
+            { rapidjson_impl::to_json_stream_vector_enums(os, v, enum_value_N, json_indent); },
+            file_write);
     }
 
     // Write vector of supported C++ fundamental types UTF-8 JSON to a file.
@@ -73,13 +294,17 @@ namespace easy_serialize
     // \param filename: "path/to/filename.json"
     // \param v: vector of enums to write
     // \param json_indent: JSON indent formatting
+    // \param file_write: how to write the file
     // \return status
     template <typename T>
     EasySerializeStatus to_json_file_vector(const std::string &filename, std::vector<T> &v,
-                                            JsonIndent json_indent = JsonIndent::two_spaces)
+                                            JsonIndent json_indent = JsonIndent::two_spaces,
+                                            JsonFileWrite file_write = JsonFileWrite::overwrite)
     {
-        std::string json = to_json_string_vector(v, json_indent);
-        return to_file(filename, json);
+        return rapidjson_impl::write_json_file_stream(
+            filename, [&v, json_indent](rapidjson_impl::FileOutputStream &os)
+            { rapidjson_impl::to_json_stream_vector(os, v, json_indent); },
+            file_write);
     }
 
-} // namespace easy_serialize
\ No newline at end of file
+} // namespace easy_serialize
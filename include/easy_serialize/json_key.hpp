@@ -0,0 +1,74 @@
+// easy_serialize member key with its length and hash worked out ahead of use, at compile time for
+// literals in optimized builds.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace easy_serialize
+{
+    // FNV-1a hash of a member name.
+    constexpr uint32_t hash_key(const char *name, size_t length)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; ++i)
+        {
+            hash = (hash ^ static_cast<unsigned char>(name[i])) * 16777619u;
+        }
+        return hash;
+    }
+
+    // Length of the string in a char array, up to its first null.
+    constexpr size_t key_length(const char *name, size_t size)
+    {
+        size_t length = 0;
+        while (length < size && name[length] != '\0')
+        {
+            ++length;
+        }
+        return length;
+    }
+
+    // Whether a member name is written to JSON as it is, between quotes: it has no quotes,
+    // backslashes or control characters to escape.
+    constexpr bool key_is_plain(const char *name, size_t length)
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            const auto c = static_cast<unsigned char>(name[i]);
+            if (c < 0x20 || c == '"' || c == '\\')
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Key passed to the archives' ez() functions. Finding a member compares lengths and hashes
+    // before any bytes, and writing a plain key copies it without checking it for escapes. Made
+    // from a string literal, the length, hash and plainness are constant expressions. The
+    // language only requires them to be worked out at compile time where a constant is needed
+    // (e.g. a constexpr JsonKey), but optimized builds usually fold them where ez() is inlined.
+    // Made from a const char *, they are worked out when it's made.
+    struct JsonKey
+    {
+        // Members are initialized in declaration order, so the length is only worked out once.
+        template <size_t N>
+        constexpr JsonKey(const char (&name_)[N])
+            : name(name_), length(key_length(name_, N)), hash(hash_key(name_, length)),
+              plain(key_is_plain(name_, length)) {}
+
+        template <typename Ptr,
+                  typename std::enable_if<std::is_same<Ptr, const char *>::value || std::is_same<Ptr, char *>::value,
+                                          int>::type = 0>
+        JsonKey(const Ptr &name_)
+            : name(name_), length(std::strlen(name_)), hash(hash_key(name_, length)), plain(key_is_plain(name_, length)) {}
+
+        const char *name;
+        size_t length;
+        uint32_t hash;
+        bool plain;
+    };
+} // namespace easy_serialize
@@ -0,0 +1,430 @@
+// easy_serialize reader for JSON Lines (newline-delimited JSON) using several threads.
+#pragma once
+
+#include "json_lines_reader.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace easy_serialize
+{
+    namespace rapidjson_impl
+    {
+        // Lines of JSON Lines read by a worker: the objects of the block's non-blank lines, with
+        // their line numbers (counted from the start of the block) and statuses.
+        template <typename T>
+        struct JsonLinesBlock
+        {
+            // Text of the block, whole lines. Either points into the caller's buffer or owns the
+            // text read from a file (which is then parsed in place).
+            const char *data = nullptr;
+            size_t size = 0;
+            std::vector<char> storage;
+
+            size_t num_lines = 0;
+            std::vector<size_t> line_numbers;
+            std::vector<EasySerializeStatus> statuses;
+            std::vector<T> objs;
+        };
+
+        // Splits a buffer into blocks of whole lines.
+        class JsonLinesBufferSource
+        {
+        public:
+            JsonLinesBufferSource(const char *buffer, size_t buffer_size, size_t block_size)
+                : _next(buffer), _end(buffer + buffer_size), _block_size(block_size) {}
+
+            // \return: false if there are no more blocks
+            template <typename T>
+            bool next(JsonLinesBlock<T> &block)
+            {
+                if (_next == _end)
+                {
+                    return false;
+                }
+                const char *block_end = _next + std::min(_block_size, static_cast<size_t>(_end - _next));
+                const char *newline = static_cast<const char *>(
+                    std::memchr(block_end, '\n', static_cast<size_t>(_end - block_end)));
+                block_end = newline ? newline + 1 : _end;
+                block.data = _next;
+                block.size = static_cast<size_t>(block_end - _next);
+                _next = block_end;
+                return true;
+            }
+
+            EasySerializeStatus status() const { return EasySerializeStatus(); }
+
+        private:
+            const char *_next;
+            const char *_end;
+            size_t _block_size;
+        };
+
+        // Reads a file in blocks of whole lines.
+        class JsonLinesFileSource
+        {
+        public:
+            JsonLinesFileSource(const std::string &filename, size_t block_size)
+                : _fp(std::fopen(filename.c_str(), "rb")), _block_size(block_size)
+            {
+                if (!_fp)
+                {
+                    _status.set_error_message("File opening failed.");
+                }
+            }
+            ~JsonLinesFileSource()
+            {
+                if (_fp)
+                {
+                    std::fclose(_fp);
+                }
+            }
+            JsonLinesFileSource(const JsonLinesFileSource &) = delete;
+            JsonLinesFileSource &operator=(const JsonLinesFileSource &) = delete;
+
+            // \return: false if there are no more blocks (or reading failed, see status())
+            template <typename T>
+            bool next(JsonLinesBlock<T> &block)
+            {
+                if (!_fp || !_status)
+                {
+                    return false;
+                }
+                // Start with the partial line left over from the last block, then read until
+                // there's a '\n' to end the block at, or the end of the file.
+                block.storage.swap(_partial_line);
+                _partial_line.clear();
+                for (;;)
+                {
+                    const size_t old_size = block.storage.size();
+                    block.storage.resize(old_size + _block_size);
+                    const size_t bytes_read = std::fread(block.storage.data() + old_size, 1, _block_size, _fp);
+                    block.storage.resize(old_size + bytes_read);
+                    if (bytes_read == 0)
+                    {
+                        if (std::ferror(_fp))
+                        {
+                            _status.set_error_message("File reading error.");
+                            return false;
+                        }
+                        break;
+                    }
+                    size_t last_newline = block.storage.size();
+                    while (last_newline > old_size && block.storage[last_newline - 1] != '\n')
+                    {
+                        --last_newline;
+                    }
+                    if (last_newline > old_size)
+                    {
+                        _partial_line.assign(block.storage.begin() + static_cast<std::ptrdiff_t>(last_newline),
+                                             block.storage.end());
+                        block.storage.resize(last_newline);
+                        break;
+                    }
+                }
+                if (block.storage.empty())
+                {
+                    return false;
+                }
+                block.data = block.storage.data();
+                block.size = block.storage.size();
+                return true;
+            }
+
+            EasySerializeStatus status() const { return _status; }
+
+        private:
+            std::FILE *_fp;
+            size_t _block_size;
+            std::vector<char> _partial_line;
+            EasySerializeStatus _status;
+        };
+
+        // Reads JSON Lines from a source with a pool of worker threads, and hands the lines to a
+        // callback on the calling thread in their original order.
+        //
+        // Workers take the next block from the source, read its lines with their own
+        // JsonLinesReader (so each reuses its own reader state), and queue the results. The
+        // calling thread delivers the blocks in order. At most a few blocks per worker are in
+        // flight, so memory is bounded however long the input is.
+        template <typename T, typename Source>
+        class ParallelJsonLinesReader
+        {
+        public:
+            ParallelJsonLinesReader(Source &source, unsigned num_threads)
+                : _source(source), _num_threads(num_threads > 0 ? num_threads : default_num_threads()),
+                  _max_blocks_in_flight(4 * static_cast<size_t>(_num_threads)) {}
+
+            // Read all lines, calling bool callback(size_t line_number, const EasySerializeStatus
+            // &status, T &obj) for each non-blank line in order until it returns false.
+            //
+            // \return: source status (error if the file couldn't be read)
+            template <typename Callback>
+            EasySerializeStatus read(Callback &callback)
+            {
+                std::vector<std::thread> workers;
+                for (unsigned i = 0; i < _num_threads; ++i)
+                {
+                    workers.emplace_back([this]() { work(); });
+                }
+                size_t first_line_number = 1;
+                bool more = true;
+                while (more)
+                {
+                    std::unique_ptr<JsonLinesBlock<T>> block;
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _block_finished.wait(lock, [this]() {
+                            return _finished.count(_num_delivered) || (_source_done && _num_taken == _num_delivered);
+                        });
+                        const auto it = _finished.find(_num_delivered);
+                        if (it == _finished.end())
+                        {
+                            break;
+                        }
+                        block = std::move(it->second);
+                        _finished.erase(it);
+                        ++_num_delivered;
+                    }
+                    _room_for_block.notify_all();
+                    for (size_t i = 0; more && i < block->objs.size(); ++i)
+                    {
+                        more = callback(first_line_number + block->line_numbers[i], block->statuses[i],
+                                        block->objs[i]);
+                    }
+                    first_line_number += block->num_lines;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _stop = true;
+                }
+                _room_for_block.notify_all();
+                for (auto &worker : workers)
+                {
+                    worker.join();
+                }
+                return _source.status();
+            }
+
+        private:
+            // Collects the lines of the block a worker is reading. Objects are copied out, so the
+            // worker's reader keeps reusing its object (and the memory it holds) for the next line.
+            class BlockCollector
+            {
+            public:
+                bool operator()(size_t line_number, const EasySerializeStatus &status, T &obj)
+                {
+                    block->line_numbers.push_back(line_number - first_line_number);
+                    block->statuses.push_back(status);
+                    block->objs.push_back(obj);
+                    return true;
+                }
+                JsonLinesBlock<T> *block = nullptr;
+                size_t first_line_number = 0;
+            };
+
+            void work()
+            {
+                BlockCollector collector;
+                JsonLinesReader<T, BlockCollector> reader(collector);
+                for (;;)
+                {
+                    std::unique_ptr<JsonLinesBlock<T>> block(new JsonLinesBlock<T>());
+                    size_t index = 0;
+                    {
+                        // One worker reads the source at a time, so blocks are numbered in the
+                        // order they're read. _mutex isn't held while reading, so a slow read
+                        // doesn't hold up the other workers handing over their blocks, or their
+                        // delivery.
+                        std::lock_guard<std::mutex> source_lock(_source_mutex);
+                        {
+                            std::unique_lock<std::mutex> lock(_mutex);
+                            _room_for_block.wait(lock, [this]() {
+                                return _stop || _source_done || _num_taken < _num_delivered + _max_blocks_in_flight;
+                            });
+                            if (_stop || _source_done)
+                            {
+                                return;
+                            }
+                        }
+                        const bool more = _source.next(*block);
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        if (!more)
+                        {
+                            _source_done = true;
+                            _block_finished.notify_all();
+                            return;
+                        }
+                        index = _num_taken++;
+                    }
+
+                    collector.block = block.get();
+                    collector.first_line_number = reader.lineNumber() + 1;
+                    if (block->storage.empty())
+                    {
+                        read_json_lines(reader, block->data, block->size);
+                    }
+                    else
+                    {
+                        read_json_lines(reader, block->storage.data(), block->size);
+                    }
+                    block->num_lines = reader.lineNumber() + 1 - collector.first_line_number;
+
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _finished[index] = std::move(block);
+                    _block_finished.notify_all();
+                }
+            }
+
+            Source &_source;
+            const unsigned _num_threads;
+            const size_t _max_blocks_in_flight;
+
+            // Held by the worker reading _source, and taken before _mutex.
+            std::mutex _source_mutex;
+            std::mutex _mutex;
+            std::condition_variable _room_for_block;
+            std::condition_variable _block_finished;
+            // Guarded by _mutex.
+            std::map<size_t, std::unique_ptr<JsonLinesBlock<T>>> _finished;
+            size_t _num_taken = 0;
+            size_t _num_delivered = 0;
+            bool _source_done = false;
+            bool _stop = false;
+        };
+
+        constexpr size_t JSON_LINES_BLOCK_SIZE = 1024 * 1024;
+
+        // Collects the objects of JSON Lines into a vector, stopping at the first line that fails.
+        // Objects are moved out of the blocks ParallelJsonLinesReader delivers, which are dropped
+        // once delivered.
+        template <typename T>
+        class JsonLinesVectorCollector
+        {
+        public:
+            explicit JsonLinesVectorCollector(std::vector<T> &v) : _v(v) { _v.clear(); }
+
+            bool operator()(size_t line_number, const EasySerializeStatus &status, T &obj)
+            {
+                if (!status)
+                {
+                    _status.set_error_message("line " + std::to_string(line_number) + ": " +
+                                              status.get_error_message());
+                    return false;
+                }
+                _v.push_back(std::move(obj));
+                return true;
+            }
+
+            // \return: status of the first line that failed, or the source's status
+            EasySerializeStatus status(const EasySerializeStatus &source_status) const
+            {
+                return _status ? source_status : _status;
+            }
+
+        private:
+            std::vector<T> &_v;
+            EasySerializeStatus _status;
+        };
+    } // namespace rapidjson_impl
+
+    // Read JSON Lines (one JSON object per line) from a buffer with several threads, calling
+    // callback for each line in order. Like for_each_json_line(), but the buffer is split into
+    // blocks of lines that are read in parallel.
+    //
+    // The callback is called on the calling thread as bool callback(size_t line_number, const
+    // EasySerializeStatus &status, T &obj), with line numbers from 1, skipping blank lines.
+    // Return true to carry on, false to stop.
+    //
+    // \param buffer: buffer of UTF-8 JSON Lines
+    // \param buffer_size: size of buffer
+    // \param callback: called for each line
+    // \param num_threads: number of worker threads, 0 for one per hardware thread
+    template <typename T, typename Callback>
+    void for_each_json_line_parallel(const char *buffer, size_t buffer_size, Callback callback,
+                                     unsigned num_threads = 0)
+    {
+        rapidjson_impl::JsonLinesBufferSource source(buffer, buffer_size, rapidjson_impl::JSON_LINES_BLOCK_SIZE);
+        rapidjson_impl::ParallelJsonLinesReader<T, rapidjson_impl::JsonLinesBufferSource> reader(source,
+                                                                                                  num_threads);
+        reader.read(callback);
+    }
+
+    // Read JSON Lines from a string with several threads, calling callback for each line in
+    // order. See for_each_json_line_parallel() for buffers.
+    //
+    // \param json: std::string of UTF-8 JSON Lines
+    // \param callback: called for each line
+    // \param num_threads: number of worker threads, 0 for one per hardware thread
+    template <typename T, typename Callback>
+    void for_each_json_line_parallel(const std::string &json, Callback callback, unsigned num_threads = 0)
+    {
+        for_each_json_line_parallel<T>(json.data(), json.size(), callback, num_threads);
+    }
+
+    // Read a JSON Lines file with several threads, calling callback for each line in order. See
+    // for_each_json_line_parallel() for buffers.
+    //
+    // The file is read in blocks of lines that are parsed in place. Only a few blocks per thread
+    // are in memory at a time, however big the file is.
+    //
+    // \param filename: name of file
+    // \param callback: called for each line
+    // \param num_threads: number of worker threads, 0 for one per hardware thread
+    // \return: EasySerializeStatus object, an error only if the file couldn't be read (errors in
+    //          lines go to the callback)
+    template <typename T, typename Callback>
+    EasySerializeStatus for_each_json_line_file_parallel(const std::string &filename, Callback callback,
+                                                         unsigned num_threads = 0)
+    {
+        rapidjson_impl::JsonLinesFileSource source(filename, rapidjson_impl::JSON_LINES_BLOCK_SIZE);
+        rapidjson_impl::ParallelJsonLinesReader<T, rapidjson_impl::JsonLinesFileSource> reader(source,
+                                                                                                num_threads);
+        return reader.read(callback);
+    }
+
+    // Populate a std::vector of objects from UTF-8 JSON Lines in a string, one object per
+    // non-blank line, reading with several threads. Stops at the first line that fails to read;
+    // its error message starts with "line <number>: ".
+    //
+    // \param json: std::string of UTF-8 JSON Lines
+    // \param v: vector of objects to populate
+    // \param num_threads: number of worker threads, 0 for one per hardware thread
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_lines_string_parallel(const std::string &json, std::vector<T> &v,
+                                                        unsigned num_threads = 0)
+    {
+        rapidjson_impl::JsonLinesVectorCollector<T> collector(v);
+        for_each_json_line_parallel<T>(json, std::ref(collector), num_threads);
+        return collector.status(EasySerializeStatus());
+    }
+
+    // Populate a std::vector of objects from a UTF-8 JSON Lines file, one object per non-blank
+    // line, reading with several threads. Stops at the first line that fails to read; its error
+    // message starts with "line <number>: ".
+    //
+    // \param filename: name of file
+    // \param v: vector of objects to populate
+    // \param num_threads: number of worker threads, 0 for one per hardware thread
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_lines_file_parallel(const std::string &filename, std::vector<T> &v,
+                                                      unsigned num_threads = 0)
+    {
+        rapidjson_impl::JsonLinesVectorCollector<T> collector(v);
+        const EasySerializeStatus status = for_each_json_line_file_parallel<T>(filename, std::ref(collector),
+                                                                               num_threads);
+        return collector.status(status);
+    }
+} // namespace easy_serialize
@@ -0,0 +1,317 @@
+// easy_serialize reader for JSON Lines (newline-delimited JSON), one object per line.
+#pragma once
+
+#include "json_key.hpp"
+#include "json_reader.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace easy_serialize
+{
+    namespace rapidjson_impl
+    {
+        // Archive that runs serialize() on default constructed objects to find out whether a type,
+        // or any type of object it holds, uses object versioning. Reading such an object can leave
+        // members unread (those newer than the JSON's object version).
+        class VersionProbeArchive
+        {
+        public:
+            void class_version(const int /*class_version_*/) { versioned = true; }
+            template <typename T>
+            void ez(JsonKey /*key*/, T & /*t*/, int object_version_supported = 0)
+            {
+                note(object_version_supported);
+            }
+            template <typename T>
+            void ez_enum(JsonKey /*key*/, T & /*e*/, T /*enum_value_N*/, int object_version_supported = 0)
+            {
+                note(object_version_supported);
+            }
+            template <typename T>
+            void ez_object(JsonKey /*key*/, T &o, int object_version_supported = 0)
+            {
+                note(object_version_supported);
+                probe(o);
+            }
+            template <typename T>
+            void ez_vector(JsonKey /*key*/, std::vector<T> & /*v*/, int object_version_supported = 0)
+            {
+                note(object_version_supported);
+            }
+            template <typename T>
+            void ez_vector_enums(JsonKey /*key*/, std::vector<T> & /*v*/, T /*enum_value_N*/,
+                                 int object_version_supported = 0)
+            {
+                note(object_version_supported);
+            }
+            template <typename T>
+            void ez_vector_objects(JsonKey /*key*/, std::vector<T> & /*v*/, int object_version_supported = 0)
+            {
+                note(object_version_supported);
+                T o;
+                probe(o);
+            }
+
+            // Run o's serialize(). A type that holds itself is only followed a few levels deep: any
+            // versioning in it shows up on the first.
+            template <typename T>
+            void probe(T &o)
+            {
+                if (!versioned && _depth < 8)
+                {
+                    ++_depth;
+                    o.serialize(*this);
+                    --_depth;
+                }
+            }
+
+            bool versioned = false;
+
+        private:
+            void note(int object_version_supported)
+            {
+                versioned = versioned || object_version_supported > 0;
+            }
+
+            int _depth = 0;
+        };
+
+        // Whether reading a T can leave members of it unread. See VersionProbeArchive.
+        template <typename T>
+        bool is_versioned()
+        {
+            static const bool versioned = []()
+            {
+                T o;
+                VersionProbeArchive a;
+                a.probe(o);
+                return a.versioned;
+            }();
+            return versioned;
+        }
+
+        // Reads lines of JSON into one reused object and hands each to a callback. Blank lines are
+        // skipped but still counted.
+        //
+        // The object is reset to a default constructed one before a line when the line could
+        // leave members of it unread (types using object versioning), and after a line that
+        // fails, so it never has members left over from an earlier line.
+        template <typename T, typename Callback>
+        class JsonLinesReader
+        {
+        public:
+            explicit JsonLinesReader(Callback &callback) : _callback(callback)
+            {
+                _context.set_reuse_vector_elements(true);
+            }
+
+            // Read a line (without its '\n') from a buffer that stays untouched.
+            //
+            // \return: false if the callback asked to stop
+            bool line(const char *line, size_t size)
+            {
+                ++_line_number;
+                if (isBlank(line, size))
+                {
+                    return true;
+                }
+                if (is_versioned<T>())
+                {
+                    _obj = T();
+                }
+                const EasySerializeStatus status = from_json_buffer(line, size, _obj, _context);
+                return deliver(status);
+            }
+
+            // Read a line (without its '\n') in place. The line is garbage afterwards.
+            //
+            // \return: false if the callback asked to stop
+            bool line(char *line, size_t size)
+            {
+                ++_line_number;
+                if (isBlank(line, size))
+                {
+                    return true;
+                }
+                if (is_versioned<T>())
+                {
+                    _obj = T();
+                }
+                const EasySerializeStatus status = from_json_buffer_insitu(line, size, _obj, _context);
+                return deliver(status);
+            }
+
+            // Number of lines read so far, including blank ones.
+            size_t lineNumber() const { return _line_number; }
+
+        private:
+            bool deliver(const EasySerializeStatus &status)
+            {
+                if (!status)
+                {
+                    _obj = T();
+                }
+                return _callback(_line_number, status, _obj);
+            }
+            static bool isBlank(const char *line, size_t size)
+            {
+                for (size_t i = 0; i < size; ++i)
+                {
+                    if (line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            Callback &_callback;
+            RapidJsonReaderContext _context;
+            T _obj = T();
+            size_t _line_number = 0;
+        };
+
+        // Read each line of a buffer with a JsonLinesReader, in place if the buffer is mutable.
+        //
+        // \param reader: JsonLinesReader
+        // \param buffer: buffer of UTF-8 JSON Lines (char * is parsed in place, const char * isn't)
+        // \param buffer_size: size of buffer
+        // \return: false if the callback asked to stop
+        template <typename Reader, typename Ch>
+        bool read_json_lines(Reader &reader, Ch *buffer, size_t buffer_size)
+        {
+            Ch *end = buffer + buffer_size;
+            Ch *line = buffer;
+            while (line != end)
+            {
+                Ch *newline = static_cast<Ch *>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+                Ch *line_end = newline ? newline : end;
+                if (!reader.line(line, static_cast<size_t>(line_end - line)))
+                {
+                    return false;
+                }
+                if (!newline)
+                {
+                    break;
+                }
+                line = newline + 1;
+            }
+            return true;
+        }
+    } // namespace rapidjson_impl
+
+    // Read JSON Lines (one JSON object per line) from a buffer, calling callback for each line.
+    //
+    // Every line is read into the same object, reusing its memory (see
+    // JsonReaderContext::set_reuse_vector_elements), so the callback should copy out whatever it
+    // keeps (and not move from obj). Blank lines are skipped. A line that fails to read doesn't
+    // stop the others.
+    //
+    // obj is the same as reading the line with from_json_string() into a new object: for types
+    // that use object versioning (or hold objects that do) it's reset before every line, since a
+    // line of an older version leaves newer members unread. A serialize() that picks its members
+    // by the object's own state can still see the previous line's values, as with any reused
+    // object.
+    //
+    // The callback is called as bool callback(size_t line_number, const EasySerializeStatus &status,
+    // T &obj), with line numbers from 1. If status is an error, obj is default constructed. Return
+    // true to carry on, false to stop.
+    //
+    // \param buffer: buffer of UTF-8 JSON Lines
+    // \param buffer_size: size of buffer
+    // \param callback: called for each line
+    template <typename T, typename Callback>
+    void for_each_json_line(const char *buffer, size_t buffer_size, Callback callback)
+    {
+        rapidjson_impl::JsonLinesReader<T, Callback> reader(callback);
+        rapidjson_impl::read_json_lines(reader, buffer, buffer_size);
+    }
+
+    // Read JSON Lines from a string, calling callback for each line. See for_each_json_line() for
+    // buffers.
+    //
+    // \param json: std::string of UTF-8 JSON Lines
+    // \param callback: called for each line
+    template <typename T, typename Callback>
+    void for_each_json_line(const std::string &json, Callback callback)
+    {
+        for_each_json_line<T>(json.data(), json.size(), callback);
+    }
+
+    // Read a JSON Lines file, calling callback for each line. See for_each_json_line() for
+    // buffers.
+    //
+    // The file is read a chunk at a time and each line parsed in place, so memory use is bounded
+    // by chunk_size or the longest line, whichever is bigger, however big the file is.
+    //
+    // \param filename: name of file
+    // \param callback: called for each line
+    // \param chunk_size: bytes to read from the file at a time
+    // \return: EasySerializeStatus object, an error only if the file couldn't be read (errors in
+    //          lines go to the callback)
+    template <typename T, typename Callback>
+    EasySerializeStatus for_each_json_line_file(const std::string &filename, Callback callback,
+                                                size_t chunk_size = 64 * 1024)
+    {
+        EasySerializeStatus status;
+        std::FILE *fp = std::fopen(filename.c_str(), "rb");
+        if (!fp)
+        {
+            status.set_error_message("File opening failed.");
+            return status;
+        }
+        rapidjson_impl::JsonLinesReader<T, Callback> reader(callback);
+        std::vector<char> buffer(chunk_size > 0 ? chunk_size : 1);
+        // Unread lines are in [begin, end), and there's no '\n' in [begin, searched).
+        size_t begin = 0;
+        size_t searched = 0;
+        size_t end = 0;
+        for (;;)
+        {
+            void *newline = std::memchr(buffer.data() + searched, '\n', end - searched);
+            if (newline)
+            {
+                const size_t line_end = static_cast<size_t>(static_cast<char *>(newline) - buffer.data());
+                if (!reader.line(buffer.data() + begin, line_end - begin))
+                {
+                    break;
+                }
+                begin = searched = line_end + 1;
+                continue;
+            }
+            searched = end;
+            // Move the partial line to the front, growing the buffer if it's already full of it.
+            if (begin > 0)
+            {
+                std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+                end -= begin;
+                searched -= begin;
+                begin = 0;
+            }
+            else if (end == buffer.size())
+            {
+                buffer.resize(buffer.size() * 2);
+            }
+            const size_t bytes_read = std::fread(buffer.data() + end, 1, buffer.size() - end, fp);
+            end += bytes_read;
+            if (bytes_read == 0)
+            {
+                if (std::ferror(fp))
+                {
+                    status.set_error_message("File reading error.");
+                }
+                else if (begin != end)
+                {
+                    // Last line, with no '\n'.
+                    reader.line(buffer.data() + begin, end - begin);
+                }
+                break;
+            }
+        }
+        std::fclose(fp);
+        return status;
+    }
+} // namespace easy_serialize
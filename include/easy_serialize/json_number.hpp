@@ -0,0 +1,244 @@
+// easy_serialize number formatting for the JSON writers.
+#pragma once
+
+#include "easy_serialize_config.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#if EASY_SERIALIZE_HAS_TO_CHARS
+#include <charconv>
+#endif
+
+namespace easy_serialize
+{
+    // Room for any number written by write_uint64, write_int64 or write_double.
+    constexpr size_t max_number_length = 32;
+
+    // Number of decimal digits in value.
+    inline unsigned count_digits(uint64_t value)
+    {
+        unsigned n = 1;
+        for (;;)
+        {
+            if (value < 10)
+            {
+                return n;
+            }
+            if (value < 100)
+            {
+                return n + 1;
+            }
+            if (value < 1000)
+            {
+                return n + 2;
+            }
+            if (value < 10000)
+            {
+                return n + 3;
+            }
+            value /= 10000;
+            n += 4;
+        }
+    }
+
+    // Write value in decimal, two digits at a time from the end.
+    //
+    // \param value: value to write
+    // \param buffer: at least max_number_length chars
+    // \return: end of the number written
+    inline char *write_uint64(uint64_t value, char *buffer)
+    {
+        static const char digit_pairs[] =
+            "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+            "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+        char *const end = buffer + count_digits(value);
+        char *p = end;
+        while (value >= 100)
+        {
+            const size_t i = static_cast<size_t>(value % 100) * 2;
+            value /= 100;
+            p -= 2;
+            p[0] = digit_pairs[i];
+            p[1] = digit_pairs[i + 1];
+        }
+        if (value >= 10)
+        {
+            const size_t i = static_cast<size_t>(value) * 2;
+            p[-2] = digit_pairs[i];
+            p[-1] = digit_pairs[i + 1];
+        }
+        else
+        {
+            p[-1] = static_cast<char>('0' + value);
+        }
+        return end;
+    }
+
+    // Write value in decimal.
+    //
+    // \param value: value to write
+    // \param buffer: at least max_number_length chars
+    // \return: end of the number written
+    inline char *write_int64(int64_t value, char *buffer)
+    {
+        uint64_t magnitude = static_cast<uint64_t>(value);
+        if (value < 0)
+        {
+            *buffer++ = '-';
+            magnitude = 0 - magnitude;
+        }
+        return write_uint64(magnitude, buffer);
+    }
+
+    // Write a decimal exponent the way rapidjson does: no '+' and no leading zeros.
+    inline char *write_exponent(int exponent, char *buffer)
+    {
+        if (exponent < 0)
+        {
+            *buffer++ = '-';
+            exponent = -exponent;
+        }
+        return write_uint64(static_cast<uint64_t>(exponent), buffer);
+    }
+
+    // Shortest decimal digits that read back as value, and their exponent: value is
+    // 0.digits * 10^point. value must be finite and positive.
+    //
+    // \param digits: at least 17 chars, gets the digits with no trailing zeros
+    // \param point: gets the position of the decimal point relative to the first digit
+    // \return: number of digits
+    inline int shortest_digits(double value, char *digits, int &point)
+    {
+        char text[max_number_length];
+        const char *end = text;
+#if EASY_SERIALIZE_HAS_TO_CHARS
+        // Shortest round trip, e.g. "1.2345e+02".
+        end = std::to_chars(text, text + sizeof(text), value, std::chars_format::scientific).ptr;
+#else
+        // The fewest significant digits out of 15, 16 and 17 that read back as value. Where
+        // std::to_chars isn't available, this isn't always the shortest, but always round trips.
+        for (int precision = 15; precision <= 17; ++precision)
+        {
+            const int n = std::snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+            end = text + n;
+            if (precision == 17 || std::strtod(text, nullptr) == value)
+            {
+                break;
+            }
+        }
+#endif
+        int length = 0;
+        const char *p = text;
+        // Digits up to the exponent, skipping the decimal point (whatever the locale makes it).
+        for (; p != end && *p != 'e'; ++p)
+        {
+            if (*p >= '0' && *p <= '9')
+            {
+                digits[length++] = *p;
+            }
+        }
+        while (length > 1 && digits[length - 1] == '0')
+        {
+            --length;
+        }
+        // Exponent, e.g. "e+02" or "e-308" (the text isn't null terminated).
+        bool negative = false;
+        int exponent = 0;
+        for (++p; p < end; ++p)
+        {
+            if (*p == '-')
+            {
+                negative = true;
+            }
+            else if (*p >= '0' && *p <= '9')
+            {
+                exponent = exponent * 10 + (*p - '0');
+            }
+        }
+        point = (negative ? -exponent : exponent) + 1;
+        return length;
+    }
+
+    // Write a finite double with the fewest digits that read back as the same value, laid out
+    // like rapidjson's Writer::Double: fixed notation (with ".0" on integers) for values from
+    // 1e-6 up to 1e21, otherwise an exponent, e.g. 0.001, 1.5, 100.0, 1e21, 1.5e-7.
+    //
+    // \param value: finite value to write
+    // \param buffer: at least max_number_length chars
+    // \return: end of the number written
+    inline char *write_double(double value, char *buffer)
+    {
+        if (std::signbit(value))
+        {
+            *buffer++ = '-';
+            value = -value;
+        }
+        if (value == 0.0)
+        {
+            buffer[0] = '0';
+            buffer[1] = '.';
+            buffer[2] = '0';
+            return buffer + 3;
+        }
+        char digits[max_number_length];
+        int point = 0;
+        const int length = shortest_digits(value, digits, point);
+        if (length <= point && point <= 21)
+        {
+            // 1234e7 -> 12340000000.0
+            for (int i = 0; i < point; ++i)
+            {
+                *buffer++ = i < length ? digits[i] : '0';
+            }
+            *buffer++ = '.';
+            *buffer++ = '0';
+        }
+        else if (0 < point && point <= 21)
+        {
+            // 1234e-2 -> 12.34
+            for (int i = 0; i < length; ++i)
+            {
+                if (i == point)
+                {
+                    *buffer++ = '.';
+                }
+                *buffer++ = digits[i];
+            }
+        }
+        else if (-6 < point && point <= 0)
+        {
+            // 1234e-6 -> 0.001234
+            *buffer++ = '0';
+            *buffer++ = '.';
+            for (int i = point; i < 0; ++i)
+            {
+                *buffer++ = '0';
+            }
+            for (int i = 0; i < length; ++i)
+            {
+                *buffer++ = digits[i];
+            }
+        }
+        else
+        {
+            // 1234e30 -> 1.234e33
+            *buffer++ = digits[0];
+            if (length > 1)
+            {
+                *buffer++ = '.';
+                for (int i = 1; i < length; ++i)
+                {
+                    *buffer++ = digits[i];
+                }
+            }
+            *buffer++ = 'e';
+            buffer = write_exponent(point - 1, buffer);
+        }
+        return buffer;
+    }
+} // namespace easy_serialize
@@ -0,0 +1,474 @@
+// easy_serialize reader for JSON that arrives in fragments, e.g. from a socket.
+#pragma once
+
+#include "easy_serialize_status.hpp"
+#include "rapidjsonreader_impl.hpp"
+
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace easy_serialize
+{
+    namespace rapidjson_impl
+    {
+        // Finds where the tokens in fragments of JSON end, so the tokenizer is only given whole
+        // tokens. Strings end at their closing quote, and numbers and literals at the next
+        // whitespace or punctuation, so a token split between fragments is found without
+        // tokenizing it.
+        class PushTokenScanner
+        {
+        public:
+            static constexpr size_t npos = static_cast<size_t>(-1);
+
+            // Scan the next bytes of the document.
+            //
+            // \param first: set to the end of the first token ending in data that isn't a ',' or
+            //               ':', or npos
+            // \param last: set to the end of the last such token, or npos
+            void scan(const char *data, size_t size, size_t &first, size_t &last)
+            {
+                first = last = npos;
+                for (size_t i = 0; i < size; ++i)
+                {
+                    const char c = data[i];
+                    switch (_state)
+                    {
+                    case State::string:
+                        if (c == '\\')
+                        {
+                            _state = State::escape;
+                        }
+                        else if (c == '"')
+                        {
+                            _state = State::between;
+                            tokenEnd(i + 1, first, last);
+                        }
+                        continue;
+                    case State::escape:
+                        _state = State::string;
+                        continue;
+                    case State::literal:
+                        if (!endsLiteral(c))
+                        {
+                            continue;
+                        }
+                        _state = State::between;
+                        tokenEnd(i, first, last);
+                        break;
+                    case State::between:
+                        break;
+                    }
+                    switch (c)
+                    {
+                    case ' ':
+                    case '\n':
+                    case '\r':
+                    case '\t':
+                    case ',':
+                    case ':':
+                        break;
+                    case '{':
+                    case '[':
+                    case '}':
+                    case ']':
+                        tokenEnd(i + 1, first, last);
+                        break;
+                    case '"':
+                        _state = State::string;
+                        break;
+                    default:
+                        _state = State::literal;
+                        break;
+                    }
+                }
+            }
+
+            void reset() { _state = State::between; }
+
+        private:
+            enum class State
+            {
+                between,
+                string,
+                // Just after a '\\' in a string.
+                escape,
+                // A number, true, false or null.
+                literal,
+            };
+
+            static bool endsLiteral(char c)
+            {
+                switch (c)
+                {
+                case ' ':
+                case '\n':
+                case '\r':
+                case '\t':
+                case ',':
+                case ':':
+                case '{':
+                case '[':
+                case '}':
+                case ']':
+                case '"':
+                    return true;
+                default:
+                    return false;
+                }
+            }
+            static void tokenEnd(size_t end, size_t &first, size_t &last)
+            {
+                if (first == npos)
+                {
+                    first = end;
+                }
+                last = end;
+            }
+
+            State _state = State::between;
+        };
+
+        // rapidjson SAX handler that builds a document's values as its tokens come in, so it can
+        // be fed by several calls to the tokenizer. With a SchemaBinder, each member of the root
+        // object is bound as soon as its value is read, and then dropped from the memory pool, so
+        // only the member being read is held.
+        class PushValueBuilder : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, PushValueBuilder>
+        {
+        public:
+            bool Null()
+            {
+                rapidjson::Value value;
+                return add(value);
+            }
+            bool Bool(bool b)
+            {
+                rapidjson::Value value;
+                value.SetBool(b);
+                return add(value);
+            }
+            bool Int(int i)
+            {
+                rapidjson::Value value;
+                value.SetInt(i);
+                return add(value);
+            }
+            bool Uint(unsigned u)
+            {
+                rapidjson::Value value;
+                value.SetUint(u);
+                return add(value);
+            }
+            bool Int64(int64_t i64)
+            {
+                rapidjson::Value value;
+                value.SetInt64(i64);
+                return add(value);
+            }
+            bool Uint64(uint64_t u64)
+            {
+                rapidjson::Value value;
+                value.SetUint64(u64);
+                return add(value);
+            }
+            bool Double(double d)
+            {
+                rapidjson::Value value;
+                value.SetDouble(d);
+                return add(value);
+            }
+            bool String(const char *str, rapidjson::SizeType length, bool /*copy*/)
+            {
+                rapidjson::Value value(str, length, *_allocator);
+                return add(value);
+            }
+            bool Key(const char *str, rapidjson::SizeType length, bool /*copy*/)
+            {
+                _stack.emplace_back(str, length, *_allocator);
+                return true;
+            }
+            bool StartObject()
+            {
+                _stack.emplace_back(rapidjson::kObjectType);
+                return true;
+            }
+            bool EndObject(rapidjson::SizeType /*member_count*/) { return endContainer(); }
+            bool StartArray()
+            {
+                _stack.emplace_back(rapidjson::kArrayType);
+                return true;
+            }
+            bool EndArray(rapidjson::SizeType /*element_count*/) { return endContainer(); }
+
+            // The document's value, once its last token has been read. A root object bound by
+            // the SchemaBinder has no members.
+            rapidjson::Value &root() { return _root; }
+
+            // Start a new document. The last document's values are dropped without being freed,
+            // which is up to their memory pool.
+            //
+            // \param values: memory pool for the values, which must have an allocator
+            // \param binder: binder started for the root object, or nullptr to build the whole
+            //                document
+            void reset(ReusableMemoryPool *values, SchemaBinder *binder)
+            {
+                _values = values;
+                _allocator = values->allocator();
+                _binder = binder;
+                _stack.clear();
+                _root.SetNull();
+            }
+
+        private:
+            bool endContainer()
+            {
+                rapidjson::Value value;
+                value.Swap(_stack.back());
+                _stack.pop_back();
+                return add(value);
+            }
+            // Add a finished value to the array or object it's in, or make it the document's.
+            bool add(rapidjson::Value &value)
+            {
+                if (_stack.empty())
+                {
+                    _root.Swap(value);
+                    return true;
+                }
+                rapidjson::Value &top = _stack.back();
+                if (top.IsArray())
+                {
+                    top.PushBack(value, *_allocator);
+                    return true;
+                }
+                // A member, whose name is on top of its object.
+                if (_binder && _stack.size() == 2)
+                {
+                    // A member of the root object, which nothing else refers to once it's bound.
+                    _binder->member(top.GetString(), top.GetStringLength(), value);
+                    _stack.pop_back();
+                    _values->clear();
+                    return true;
+                }
+                _stack[_stack.size() - 2].AddMember(top, value, *_allocator);
+                _stack.pop_back();
+                return true;
+            }
+
+            ReusableMemoryPool *_values = nullptr;
+            ReusableMemoryPool::Allocator *_allocator = nullptr;
+            SchemaBinder *_binder = nullptr;
+            // Arrays and objects being built, outermost first, each object followed by the name
+            // of the member being read, if any. Held outside the memory pool, which is cleared
+            // after each member bound.
+            std::vector<rapidjson::Value> _stack;
+            rapidjson::Value _root;
+        };
+    } // namespace rapidjson_impl
+
+    // Reads an object from UTF-8 JSON that arrives in fragments, parsing the bytes as they come
+    // in instead of waiting for the whole document.
+    //
+    // feed() tokenizes each fragment where it is, on the caller's thread. Only a token split
+    // between fragments is copied, to be tokenized once the next fragment ends it, so the caller
+    // can reuse its buffer as soon as feed() returns.
+    //
+    // A type that opts in with HasFixedFields (and has no versioned fields) is bound as the bytes
+    // arrive: each member of the object is bound through the type's schema as soon as its value
+    // ends, and its value is then dropped, so only the member being read is held. Other types are
+    // built into a DOM, which finish() binds with serialize(). Results and error messages are the
+    // same as from_json_string_streaming.
+    //
+    // The memory pool for values is kept between documents, so once a reader has read its largest
+    // message (or member), reset() and feed() don't allocate. Keep one reader per connection.
+    //
+    //     easy_serialize::JsonPushReader<Message> reader(message);
+    //     while ((size = recv(socket, buffer, sizeof(buffer), 0)) > 0 && reader.feed(buffer, size)) {}
+    //     const auto status = reader.finish();
+    template <typename T>
+    class JsonPushReader
+    {
+    public:
+        // \param obj: object to populate, which must outlive the reader
+        explicit JsonPushReader(T &obj) : _obj(&obj) { start(); }
+
+        JsonPushReader(const JsonPushReader &) = delete;
+        JsonPushReader &operator=(const JsonPushReader &) = delete;
+
+        // Read the next fragment of the document.
+        //
+        // \param data: fragment of UTF-8 JSON
+        // \param size: size of fragment
+        // \return: false once the JSON is known to be malformed, so the rest needn't be fed
+        //          (finish() gives the error), or after finish()
+        bool feed(const char *data, size_t size)
+        {
+            if (_finished || !_status)
+            {
+                return false;
+            }
+            if (_ended)
+            {
+                return true;
+            }
+            // Skip a UTF-8 byte order mark, like rapidjson::EncodedInputStream.
+            static const unsigned char bom[] = {0xEF, 0xBB, 0xBF};
+            while (_bom_matched < 3 && size > 0 && static_cast<unsigned char>(*data) == bom[_bom_matched])
+            {
+                ++data;
+                --size;
+                ++_bom_matched;
+            }
+            if (size > 0)
+            {
+                _bom_matched = 3;
+            }
+
+            size_t first = 0;
+            size_t last = 0;
+            _scanner.scan(data, size, first, last);
+            size_t begin = 0;
+            if (!_carry.empty() && first != rapidjson_impl::PushTokenScanner::npos)
+            {
+                // The token split from the last fragment ends in this one.
+                _carry.insert(_carry.end(), data, data + first);
+                if (!parse(_carry.data(), _carry.size(), false))
+                {
+                    return false;
+                }
+                _carry.clear();
+                begin = first;
+            }
+            if (!_ended && _carry.empty() && last != rapidjson_impl::PushTokenScanner::npos)
+            {
+                if (!parse(data + begin, last - begin, false))
+                {
+                    return false;
+                }
+                begin = last;
+            }
+            if (!_ended)
+            {
+                _carry.insert(_carry.end(), data + begin, data + size);
+            }
+            return true;
+        }
+
+        // End the document and read the object. Later calls return the same.
+        //
+        // \return: EasySerializeStatus object
+        EasySerializeStatus finish()
+        {
+            if (!_finished)
+            {
+                _finished = true;
+                if (_status && parse(_carry.data(), _carry.size(), true))
+                {
+                    if (_binding && _builder.root().IsObject())
+                    {
+                        _status = _binder.finish();
+                    }
+                    else
+                    {
+                        static_cast<rapidjson::Value &>(*_document) = _builder.root();
+                        _status = rapidjson_impl::from_json_document(*_document, _archive, *_obj);
+                    }
+                }
+            }
+            return _status;
+        }
+
+        // Read another document. Finishes the current one first.
+        //
+        // \param obj: object to populate, which must outlive the reader or the next reset()
+        void reset(T &obj)
+        {
+            finish();
+            _obj = &obj;
+            start();
+        }
+
+    private:
+        // Get ready for a document, reusing the memory pool if the last document fit in it.
+        void start()
+        {
+            if (!_reader || _reader->HasParseError())
+            {
+                // A reader that fails part way through a document keeps some of its stack.
+                _reader.reset(new rapidjson::Reader());
+            }
+            _reader->IterativeParseInit();
+            if (_document && _values.fits())
+            {
+                _document->SetNull();
+                _values.clear();
+            }
+            else
+            {
+                _document.reset();
+                _document.reset(new rapidjson::Document(_values.rebuild()));
+            }
+            const rapidjson_impl::ObjectSchema *schema = rapidjson_impl::get_object_schema<T>();
+            _binding = rapidjson_impl::SchemaBinder::supports(schema);
+            if (_binding)
+            {
+                _binder.start(*schema, _archive, _obj);
+            }
+            _builder.reset(&_values, _binding ? &_binder : nullptr);
+            _scanner.reset();
+            _carry.clear();
+            _bom_matched = 0;
+            _status = EasySerializeStatus();
+            _ended = false;
+            _finished = false;
+        }
+
+        // Tokenize data, which ends at the end of a token other than ',' or ':', or, if ending,
+        // is the rest of the document.
+        //
+        // \return: false if the JSON is malformed
+        bool parse(const char *data, size_t size, bool ending)
+        {
+            rapidjson::MemoryStream is(data, size);
+            rapidjson::SkipWhitespace(is);
+            while (is.Peek() != '\0' || (ending && !_reader->IterativeParseComplete()))
+            {
+                if (!_reader->IterativeParseNext<rapidjson_impl::RAPIDJSON_PARSE_FLAGS>(is, _builder))
+                {
+                    _status.set_error_message(rapidjson::GetParseError_En(_reader->GetParseErrorCode()));
+                    return false;
+                }
+                rapidjson::SkipWhitespace(is);
+            }
+            // Like the other readers, a null byte ends the document.
+            _ended = _ended || is.Tell() < size;
+            return true;
+        }
+
+        T *_obj;
+        EasySerializeStatus _status;
+        bool _finished = false;
+        // A null byte was read, so the rest of the input is ignored.
+        bool _ended = false;
+        // Bytes of a UTF-8 byte order mark skipped at the start of the document, 3 once past it.
+        size_t _bom_matched = 0;
+
+        std::unique_ptr<rapidjson::Reader> _reader;
+        rapidjson_impl::PushTokenScanner _scanner;
+        // Bytes after the last whole token fed, up to the end of the last fragment.
+        std::vector<char> _carry;
+        rapidjson_impl::PushValueBuilder _builder;
+        rapidjson_impl::ReusableMemoryPool _values{16 * 1024};
+        std::unique_ptr<rapidjson::Document> _document;
+        rapidjson_impl::RapidJsonReaderArchive _archive;
+        // Whether the members of a root object are bound as they're read.
+        bool _binding = false;
+        rapidjson_impl::SchemaBinder _binder;
+    };
+} // namespace easy_serialize
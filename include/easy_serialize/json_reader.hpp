@@ -1,13 +1,19 @@
 // easy_serialize JSON reader implementation.
 #pragma once
 
+#include "rapidjsonparallelreader_impl.hpp"
 #include "rapidjsonreader_impl.hpp"
+#include "rapidjsonstreamreader_impl.hpp"
 
 #include <string>
 #include <vector>
 
 namespace easy_serialize
 {
+    // Reader state to keep between calls (one per thread) so reading stops allocating once it has
+    // warmed up. See rapidjson_impl::RapidJsonReaderContext.
+    using JsonReaderContext = rapidjson_impl::RapidJsonReaderContext;
+
     // Populate an object from a UTF-8 JSON string.
     //
     // \param json: std::string of UTF-8 JSON
@@ -30,6 +36,22 @@ namespace easy_serialize
         return rapidjson_impl::from_json_buffer_vector_objects(json.data(), json.size(), v);
     }
 
+    // Populate a std::vector of objects from a UTF-8 JSON string, reading the elements on
+    // several threads. Same results and errors as from_json_string_vector_objects (a binding
+    // error reports the lowest failing index). Worth it for arrays of many objects; the threads
+    // are started for each call.
+    //
+    // \param json: std::string of UTF-8 JSON
+    // \param v: vector of objects to populate
+    // \param num_threads: number of threads, 0 for one per hardware thread
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_string_vector_objects_parallel(const std::string &json, std::vector<T> &v,
+                                                                 unsigned num_threads = 0)
+    {
+        return rapidjson_impl::from_json_buffer_vector_objects_parallel(json.data(), json.size(), v, num_threads);
+    }
+
     // Populate a std::vector of primitive types from a UTF-8 JSON string.
     //
     // \param json: std::string of UTF-8 JSON
@@ -58,4 +80,252 @@ namespace easy_serialize
     {
         return rapidjson_impl::from_json_buffer_vector_enums(json.data(), json.size(), v, enum_value_N);
     }
+
+    // Populate an object from a UTF-8 JSON string, binding values as they are parsed rather than
+    // building a whole document in memory first. Same results and errors as from_json_string.
+    //
+    // \param json: std::string of UTF-8 JSON
+    // \param obj: object to populate
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_string_streaming(const std::string &json, T &obj)
+    {
+        return rapidjson_impl::from_json_buffer_streaming(json.data(), json.size(), obj);
+    }
+
+    // Populate a std::vector of objects from a UTF-8 JSON string, binding values as they are parsed.
+    //
+    // \param json: std::string of UTF-8 JSON
+    // \param v: vector of objects to populate
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_string_vector_objects_streaming(const std::string &json, std::vector<T> &v)
+    {
+        return rapidjson_impl::from_json_buffer_vector_objects_streaming(json.data(), json.size(), v);
+    }
+
+    // Populate a std::vector of primitive types from a UTF-8 JSON string, binding values as they
+    // are parsed.
+    //
+    // \param json: std::string of UTF-8 JSON
+    // \param v: vector of primitive types to populate
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_string_vector_streaming(const std::string &json, std::vector<T> &v)
+    {
+        return rapidjson_impl::from_json_buffer_vector_streaming(json.data(), json.size(), v);
+    }
+
+    // Populate a std::vector of enums from a UTF-8 JSON string, binding values as they are parsed.
+    //
+    // \param json: std::string of UTF-8 JSON
+    // \param v: vector of enums to populate
+    // \param enum_value_N: last enum value (not a valid value)
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_string_vector_enums_streaming(const std::string &json, std::vector<T> &v,
+                                                                T enum_value_N)
+    {
+        return rapidjson_impl::from_json_buffer_vector_enums_streaming(json.data(), json.size(), v,
+                                                                       enum_value_N);
+    }
+
+    // Populate an object from a UTF-8 JSON string, reading only the members obj's serialize()
+    // asks for (and those of its nested objects). Members it doesn't ask for on a default object
+    // are skipped by matching quotes and brackets, without parsing them, which makes picking a
+    // few members out of large objects much faster. A skipped member that serialize() asks for
+    // after all is parsed then. The catch is that other skipped members aren't validated:
+    // malformed JSON inside them goes unreported.
+    //
+    // Use a type with just the members you need to read a projection of bigger JSON.
+    //
+    // \param json: std::string of UTF-8 JSON
+    // \param obj: object to populate
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_string_projection(const std::string &json, T &obj)
+    {
+        return rapidjson_impl::from_json_buffer_projection(json.data(), json.size(), obj);
+    }
+
+    // Populate a std::vector of objects from a UTF-8 JSON string, reading only the members the
+    // objects' serialize() asks for. See from_json_string_projection().
+    //
+    // \param json: std::string of UTF-8 JSON
+    // \param v: vector of objects to populate
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_string_vector_objects_projection(const std::string &json, std::vector<T> &v)
+    {
+        return rapidjson_impl::from_json_buffer_vector_objects_projection(json.data(), json.size(), v);
+    }
+
+    // Populate an object from UTF-8 JSON in a mutable buffer, parsing in place.
+    //
+    // Strings are decoded over the buffer contents, so each one is copied only once (into obj).
+    // The buffer is garbage afterwards.
+    //
+    // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+    // \param buffer_size: size of buffer
+    // \param obj: object to populate
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_buffer_insitu(char *buffer, size_t buffer_size, T &obj)
+    {
+        return rapidjson_impl::from_json_buffer_insitu(buffer, buffer_size, obj);
+    }
+
+    // Populate a std::vector of objects from UTF-8 JSON in a mutable buffer, parsing in place.
+    // The buffer is garbage afterwards.
+    //
+    // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+    // \param buffer_size: size of buffer
+    // \param v: vector of objects to populate
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_buffer_vector_objects_insitu(char *buffer, size_t buffer_size, std::vector<T> &v)
+    {
+        return rapidjson_impl::from_json_buffer_vector_objects_insitu(buffer, buffer_size, v);
+    }
+
+    // Populate a std::vector of primitive types from UTF-8 JSON in a mutable buffer, parsing in
+    // place. The buffer is garbage afterwards.
+    //
+    // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+    // \param buffer_size: size of buffer
+    // \param v: vector of primitive types to populate
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_buffer_vector_insitu(char *buffer, size_t buffer_size, std::vector<T> &v)
+    {
+        return rapidjson_impl::from_json_buffer_vector_insitu(buffer, buffer_size, v);
+    }
+
+    // Populate a std::vector of enums from UTF-8 JSON in a mutable buffer, parsing in place.
+    // The buffer is garbage afterwards.
+    //
+    // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+    // \param buffer_size: size of buffer
+    // \param v: vector of enums to populate
+    // \param enum_value_N: last enum value (not a valid value)
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_buffer_vector_enums_insitu(char *buffer, size_t buffer_size, std::vector<T> &v,
+                                                             T enum_value_N)
+    {
+        return rapidjson_impl::from_json_buffer_vector_enums_insitu(buffer, buffer_size, v, enum_value_N);
+    }
+
+    // Populate an object from a UTF-8 JSON string, reusing the memory in context.
+    //
+    // \param json: std::string of UTF-8 JSON
+    // \param obj: object to populate
+    // \param context: reader state kept between calls
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_string(const std::string &json, T &obj, JsonReaderContext &context)
+    {
+        return rapidjson_impl::from_json_buffer(json.data(), json.size(), obj, context);
+    }
+
+    // Populate a std::vector of objects from a UTF-8 JSON string, reusing the memory in context.
+    //
+    // \param json: std::string of UTF-8 JSON
+    // \param v: vector of objects to populate
+    // \param context: reader state kept between calls
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_string_vector_objects(const std::string &json, std::vector<T> &v,
+                                                        JsonReaderContext &context)
+    {
+        return rapidjson_impl::from_json_buffer_vector_objects(json.data(), json.size(), v, context);
+    }
+
+    // Populate a std::vector of primitive types from a UTF-8 JSON string, reusing the memory in
+    // context.
+    //
+    // \param json: std::string of UTF-8 JSON
+    // \param v: vector of primitive types to populate
+    // \param context: reader state kept between calls
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_string_vector(const std::string &json, std::vector<T> &v,
+                                                JsonReaderContext &context)
+    {
+        return rapidjson_impl::from_json_buffer_vector(json.data(), json.size(), v, context);
+    }
+
+    // Populate a std::vector of enums from a UTF-8 JSON string, reusing the memory in context.
+    //
+    // \param json: std::string of UTF-8 JSON
+    // \param v: vector of enums to populate
+    // \param enum_value_N: last enum value (not a valid value)
+    // \param context: reader state kept between calls
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_string_vector_enums(const std::string &json, std::vector<T> &v,
+                                                      T enum_value_N, JsonReaderContext &context)
+    {
+        return rapidjson_impl::from_json_buffer_vector_enums(json.data(), json.size(), v, enum_value_N, context);
+    }
+
+    // Populate an object from UTF-8 JSON in a mutable buffer, parsing in place and reusing the
+    // memory in context. The buffer is garbage afterwards.
+    //
+    // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+    // \param buffer_size: size of buffer
+    // \param obj: object to populate
+    // \param context: reader state kept between calls
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_buffer_insitu(char *buffer, size_t buffer_size, T &obj, JsonReaderContext &context)
+    {
+        return rapidjson_impl::from_json_buffer_insitu(buffer, buffer_size, obj, context);
+    }
+
+    // Populate a std::vector of objects from UTF-8 JSON in a mutable buffer, parsing in place and
+    // reusing the memory in context. The buffer is garbage afterwards.
+    //
+    // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+    // \param buffer_size: size of buffer
+    // \param v: vector of objects to populate
+    // \param context: reader state kept between calls
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_buffer_vector_objects_insitu(char *buffer, size_t buffer_size, std::vector<T> &v,
+                                                               JsonReaderContext &context)
+    {
+        return rapidjson_impl::from_json_buffer_vector_objects_insitu(buffer, buffer_size, v, context);
+    }
+
+    // Populate a std::vector of primitive types from UTF-8 JSON in a mutable buffer, parsing in
+    // place and reusing the memory in context. The buffer is garbage afterwards.
+    //
+    // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+    // \param buffer_size: size of buffer
+    // \param v: vector of primitive types to populate
+    // \param context: reader state kept between calls
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_buffer_vector_insitu(char *buffer, size_t buffer_size, std::vector<T> &v,
+                                                       JsonReaderContext &context)
+    {
+        return rapidjson_impl::from_json_buffer_vector_insitu(buffer, buffer_size, v, context);
+    }
+
+    // Populate a std::vector of enums from UTF-8 JSON in a mutable buffer, parsing in place and
+    // reusing the memory in context. The buffer is garbage afterwards.
+    //
+    // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+    // \param buffer_size: size of buffer
+    // \param v: vector of enums to populate
+    // \param enum_value_N: last enum value (not a valid value)
+    // \param context: reader state kept between calls
+    // \return: EasySerializeStatus object
+    template <typename T>
+    EasySerializeStatus from_json_buffer_vector_enums_insitu(char *buffer, size_t buffer_size, std::vector<T> &v,
+                                                             T enum_value_N, JsonReaderContext &context)
+    {
+        return rapidjson_impl::from_json_buffer_vector_enums_insitu(buffer, buffer_size, v, enum_value_N, context);
+    }
 } // namespace easy_serialize
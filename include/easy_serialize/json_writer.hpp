@@ -1,14 +1,230 @@
 // easy_serialize JSON writer implementation.
 #pragma once
 
+#include "easy_serialize_config.hpp"
 #include "json_indent.hpp"
+#include "nativejsonwriter_impl.hpp"
 #include "rapidjsonwriter_impl.hpp"
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
 namespace easy_serialize
 {
+    // Output stream appending to a std::string, so JSON is written straight into it and the
+    // memory it already holds is reused.
+    class StringOutputStream
+    {
+    public:
+        typedef char Ch;
+
+        // \param json: string to append to, which must outlive the stream
+        explicit StringOutputStream(std::string &json) : _json(json) {}
+
+        void Put(Ch c) { _json.push_back(c); }
+        void Flush() {}
+
+        friend void put_plain_key(StringOutputStream &os, const char *name, size_t length)
+        {
+            os._json.push_back('"');
+            os._json.append(name, length);
+            os._json.push_back('"');
+        }
+        friend void put_number(StringOutputStream &os, const char *number, size_t length)
+        {
+            os._json.append(number, length);
+        }
+
+    private:
+        std::string &_json;
+    };
+
+    // Output stream writing into a fixed buffer. JSON that doesn't fit is cut off, and the stream
+    // keeps counting, so size() says how big the buffer needs to be.
+    class SpanOutputStream
+    {
+    public:
+        typedef char Ch;
+
+        // \param data: buffer to write to (not null terminated)
+        // \param capacity: size of buffer
+        SpanOutputStream(char *data, size_t capacity) : _data(data), _capacity(capacity) {}
+
+        void Put(Ch c)
+        {
+            if (_size < _capacity)
+            {
+                _data[_size] = c;
+            }
+            ++_size;
+        }
+        void Flush() {}
+
+        // Size of the JSON written, including any that didn't fit.
+        size_t size() const { return _size; }
+
+        // Whether the JSON didn't fit in the buffer.
+        bool overflowed() const { return _size > _capacity; }
+
+    private:
+        char *_data;
+        size_t _capacity;
+        size_t _size = 0;
+    };
+
+    // Write object UTF-8 JSON to an output stream.
+    //
+    // \param os: output stream, e.g. StringOutputStream, SpanOutputStream or any rapidjson
+    //            output stream (with Ch, Put(Ch) and Flush())
+    // \param obj: object to write
+    // \param json_indent: JSON indent formatting
+    template <typename OutputStream, typename T>
+    void to_json_stream(OutputStream &os, T &obj,
+                        JsonIndent json_indent = JsonIndent::two_spaces)
+    {
+        rapidjson_impl::to_json_stream(os, obj, json_indent);
+    }
+
+    // Append object UTF-8 JSON to a std::string.
+    //
+    // \param obj: object to write
+    // \param json: string to append to (clear() it to reuse its memory for a new message)
+    // \param json_indent: JSON indent formatting
+    template <typename T>
+    void to_json_string(T &obj, std::string &json,
+                        JsonIndent json_indent = JsonIndent::two_spaces)
+    {
+#if EASY_SERIALIZE_NATIVE_WRITER
+        native_impl::to_json_string(obj, json, json_indent);
+#else
+        StringOutputStream os(json);
+        rapidjson_impl::to_json_stream(os, obj, json_indent);
+#endif
+    }
+
+    // Write vector of objects UTF-8 JSON to an output stream.
+    //
+    // \param os: output stream, e.g. StringOutputStream, SpanOutputStream or any rapidjson
+    //            output stream (with Ch, Put(Ch) and Flush())
+    // \param v: vector of objects to write
+    // \param json_indent: JSON indent formatting
+    template <typename OutputStream, typename T>
+    void to_json_stream_vector_objects(OutputStream &os, std::vector<T> &v,
+                                       JsonIndent json_indent = JsonIndent::two_spaces)
+    {
+        rapidjson_impl::to_json_stream_vector_objects(os, v, json_indent);
+    }
+
+    // Append vector of objects UTF-8 JSON to a std::string.
+    //
+    // \param v: vector of objects to write
+    // \param json: string to append to (clear() it to reuse its memory for a new message)
+    // \param json_indent: JSON indent formatting
+    template <typename T>
+    void to_json_string_vector_objects(std::vector<T> &v, std::string &json,
+                                       JsonIndent json_indent = JsonIndent::two_spaces)
+    {
+#if EASY_SERIALIZE_NATIVE_WRITER
+        native_impl::to_json_string_vector_objects(v, json, json_indent);
+#else
+        StringOutputStream os(json);
+        rapidjson_impl::to_json_stream_vector_objects(os, v, json_indent);
+#endif
+    }
+
+    // Write vector of enums UTF-8 JSON to an output stream.
+    //
+    // \param os: output stream, e.g. StringOutputStream, SpanOutputStream or any rapidjson
+    //            output stream (with Ch, Put(Ch) and Flush())
+    // \param v: vector of enums to write
+    // \param json_indent: JSON indent formatting
+    template <typename OutputStream, typename T>
+    void to_json_stream_vector_enums(OutputStream &os, std::vector<T> &v,
+                                     JsonIndent json_indent = JsonIndent::two_spaces)
+    {
+        rapidjson_impl::to_json_stream_vector_enums(os, v, json_indent);
+    }
+
+    // Append vector of enums UTF-8 JSON to a std::string.
+    //
+    // \param v: vector of enums to write
+    // \param json: string to append to (clear() it to reuse its memory for a new message)
+    // \param json_indent: JSON indent formatting
+    template <typename T>
+    void to_json_string_vector_enums(std::vector<T> &v, std::string &json,
+                                     JsonIndent json_indent = JsonIndent::two_spaces)
+    {
+#if EASY_SERIALIZE_NATIVE_WRITER
+        native_impl::to_json_string_vector_enums(v, json, json_indent);
+#else
+        StringOutputStream os(json);
+        rapidjson_impl::to_json_stream_vector_enums(os, v, json_indent);
+#endif
+    }
+
+    // Write vector of enums UTF-8 JSON to an output stream, using the enum's cached names.
+    //
+    // \param os: output stream, e.g. StringOutputStream, SpanOutputStream or any rapidjson
+    //            output stream (with Ch, Put(Ch) and Flush())
+    // \param v: vector of enums to write
+    // \param enum_value_N: last enum value (not a valid value)
+    // \param json_indent: JSON indent formatting
+    template <typename OutputStream, typename T>
+    void to_json_stream_vector_enums(OutputStream &os, std::vector<T> &v, T enum_value_N,
+                                     JsonIndent json_indent = JsonIndent::two_spaces)
+    {
+        rapidjson_impl::to_json_stream_vector_enums(os, v, enum_value_N, json_indent);
+    }
+
+    // Append vector of enums UTF-8 JSON to a std::string, using the enum's cached names.
+    //
+    // \param v: vector of enums to write
+    // \param enum_value_N: last enum value (not a valid value)
+    // \param json: string to append to (clear() it to reuse its memory for a new message)
+    // \param json_indent: JSON indent formatting
+    template <typename T>
+    void to_json_string_vector_enums(std::vector<T> &v, T enum_value_N, std::string &json,
+                                     JsonIndent json_indent = JsonIndent::two_spaces)
+    {
+#if EASY_SERIALIZE_NATIVE_WRITER
+        native_impl::to_json_string_vector_enums(v, enum_value_N, json, json_indent);
+#else
+        StringOutputStream os(json);
+        rapidjson_impl::to_json_stream_vector_enums(os, v, enum_value_N, json_indent);
+#endif
+    }
+
+    // Write vector of supported C++ fundamental types UTF-8 JSON to an output stream.
+    //
+    // \param os: output stream, e.g. StringOutputStream, SpanOutputStream or any rapidjson
+    //            output stream (with Ch, Put(Ch) and Flush())
+    // \param v: vector of supported C++ fundamental types to write (including std::string)
+    // \param json_indent: JSON indent formatting
+    template <typename OutputStream, typename T>
+    void to_json_stream_vector(OutputStream &os, std::vector<T> &v,
+                               JsonIndent json_indent = JsonIndent::two_spaces)
+    {
+        rapidjson_impl::to_json_stream_vector(os, v, json_indent);
+    }
+
+    // Append vector of supported C++ fundamental types UTF-8 JSON to a std::string.
+    //
+    // \param v: vector of supported C++ fundamental types to write (including std::string)
+    // \param json: string to append to (clear() it to reuse its memory for a new message)
+    // \param json_indent: JSON indent formatting
+    template <typename T>
+    void to_json_string_vector(std::vector<T> &v, std::string &json,
+                               JsonIndent json_indent = JsonIndent::two_spaces)
+    {
+#if EASY_SERIALIZE_NATIVE_WRITER
+        native_impl::to_json_string_vector(v, json, json_indent);
+#else
+        StringOutputStream os(json);
+        rapidjson_impl::to_json_stream_vector(os, v, json_indent);
+#endif
+    }
+
     // Write object UTF-8 JSON to a std::string.
     //
     // \param obj: object to write
@@ -18,9 +234,9 @@ namespace easy_serialize
     std::string to_json_string(T &obj,
                                JsonIndent json_indent = JsonIndent::two_spaces)
     {
-        rapidjson::StringBuffer string_buffer;
-        rapidjson_impl::to_json_buffer(string_buffer, obj, json_indent);
-        return std::string(string_buffer.GetString(), string_buffer.GetSize());
+        std::string json;
+        to_json_string(obj, json, json_indent);
+        return json;
     }
 
     // Write vector of objects UTF-8 JSON to std::string.
@@ -32,9 +248,9 @@ namespace easy_serialize
     std::string to_json_string_vector_objects(std::vector<T> &v,
                                               JsonIndent json_indent = JsonIndent::two_spaces)
     {
-        rapidjson::StringBuffer string_buffer;
-        rapidjson_impl::to_json_buffer_vector_objects(string_buffer, v, json_indent);
-        return std::string(string_buffer.GetString(), string_buffer.GetSize());
+        std::string json;
+        to_json_string_vector_objects(v, json, json_indent);
+        return json;
     }
 
     // Write vector of enums UTF-8 JSON to std::string.
@@ -46,9 +262,24 @@ namespace easy_serialize
     std::string to_json_string_vector_enums(std::vector<T> &v,
                                             JsonIndent json_indent = JsonIndent::two_spaces)
     {
-        rapidjson::StringBuffer string_buffer;
-        rapidjson_impl::to_json_buffer_vector_enums(string_buffer, v, json_indent);
-        return std::string(string_buffer.GetString(), string_buffer.GetSize());
+        std::string json;
+        to_json_string_vector_enums(v, json, json_indent);
+        return json;
+    }
+
+    // Write vector of enums UTF-8 JSON to std::string, using the enum's cached names.
+    //
+    // \param v: vector of enums to write
+    // \param enum_value_N: last enum value (not a valid value)
+    // \param json_indent: JSON indent formatting
+    // \return vector of enums JSON in a std::string
+    template <typename T>
+    std::string to_json_string_vector_enums(std::vector<T> &v, T enum_value_N,
+                                            JsonIndent json_indent = JsonIndent::two_spaces)
+    {
+        std::string json;
+        to_json_string_vector_enums(v, enum_value_N, json, json_indent);
+        return json;
     }
 
     // Write vector of supported C++ fundamental types UTF-8 JSON to std::string.
@@ -60,9 +291,9 @@ namespace easy_serialize
     std::string to_json_string_vector(std::vector<T> &v,
                                       JsonIndent json_indent = JsonIndent::two_spaces)
     {
-        rapidjson::StringBuffer string_buffer;
-        rapidjson_impl::to_json_buffer_vector(string_buffer, v, json_indent);
-        return std::string(string_buffer.GetString(), string_buffer.GetSize());
+        std::string json;
+        to_json_string_vector(v, json, json_indent);
+        return json;
     }
 
 } // namespace easy_serialize
\ No newline at end of file
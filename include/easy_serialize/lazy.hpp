@@ -0,0 +1,124 @@
+// easy_serialize member decoded only when it is used.
+#pragma once
+
+#include "easy_serialize_status.hpp"
+#include "rapidjsonreader_impl.hpp"
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace easy_serialize
+{
+    namespace rapidjson_impl
+    {
+        // Whether T is a std::vector.
+        template <typename T>
+        struct IsVector : std::false_type
+        {
+        };
+        template <typename T>
+        struct IsVector<std::vector<T>> : std::true_type
+        {
+        };
+
+        // Decode the JSON of a Lazy object.
+        template <typename T>
+        EasySerializeStatus from_json_buffer_lazy(const std::string &json, T &obj)
+        {
+            return from_json_buffer(json.data(), json.size(), obj);
+        }
+
+        // Decode the JSON of a Lazy vector of objects.
+        template <typename T>
+        EasySerializeStatus from_json_buffer_lazy(const std::string &json, std::vector<T> &v)
+        {
+            return from_json_buffer_vector_objects(json.data(), json.size(), v);
+        }
+    } // namespace rapidjson_impl
+
+    // Member holding an object (or a std::vector of objects) that is kept as JSON text when read
+    // and only decoded into T the first time it's used. Until then, writing it copies the JSON
+    // text out unchanged, so a message can be read and written again without paying for the
+    // members it only passes along.
+    //
+    // Serialize it with ar.ez(key, lazy). The readers that read a projection copy its bytes
+    // without tokenizing them, and the other streaming readers of a buffer tokenize it and copy
+    // its bytes. The document readers have already parsed it into a DOM, so they write it back
+    // out as compact JSON, which costs about as much as binding it. A member read ahead of the
+    // ones serialize() asked for is kept as compact JSON in the same way. Either way it is
+    // checked to be an object (or array), but the projection readers only check its contents
+    // when decoded.
+    template <typename T>
+    class Lazy
+    {
+    public:
+        // JSON arrays hold a std::vector of objects, JSON objects hold an object.
+        static constexpr bool is_array = rapidjson_impl::IsVector<T>::value;
+
+        Lazy() = default;
+        Lazy(T value) : _value(std::move(value)) {}
+
+        Lazy &operator=(T value)
+        {
+            _value = std::move(value);
+            _raw.clear();
+            _decoded = true;
+            _status = EasySerializeStatus();
+            return *this;
+        }
+
+        // False while the member is JSON text that hasn't been decoded.
+        bool is_decoded() const { return _decoded; }
+
+        // JSON text of the member, until it is decoded.
+        const std::string &raw() const { return _raw; }
+
+        // Replace the member with JSON text, to be decoded when it's used. The text is not checked.
+        void set_raw(const char *json, size_t size)
+        {
+            _raw.assign(json, size);
+            _decoded = false;
+            _status = EasySerializeStatus();
+        }
+
+        // Decode the JSON text, if not done already.
+        //
+        // \return: EasySerializeStatus object. On an error, the member keeps its JSON text (so
+        //          it is still written unchanged) and the same error is returned by later calls.
+        EasySerializeStatus decode()
+        {
+            if (!_decoded && _status)
+            {
+                _value = T();
+                _status = rapidjson_impl::from_json_buffer_lazy(_raw, _value);
+                if (_status)
+                {
+                    _decoded = true;
+                    _raw.clear();
+                    _raw.shrink_to_fit();
+                }
+            }
+            return _status;
+        }
+
+        // The member, decoding it first if needed. If decoding fails (see decode()), it is
+        // partially read.
+        T &get()
+        {
+            decode();
+            return _value;
+        }
+
+    private:
+        T _value;
+        std::string _raw;
+        bool _decoded = true;
+        EasySerializeStatus _status;
+    };
+
+    template <typename T>
+    constexpr bool Lazy<T>::is_array;
+} // namespace easy_serialize
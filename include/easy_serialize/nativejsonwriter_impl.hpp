@@ -0,0 +1,561 @@
+// easy_serialize JSON writer implementation without rapidjson.
+#pragma once
+
+#include "easy_serialize_config.hpp"
+#include "enum_names.hpp"
+#include "json_indent.hpp"
+#include "json_key.hpp"
+#include "json_number.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace easy_serialize
+{
+    template <typename T>
+    class Lazy;
+
+    namespace native_impl
+    {
+        // JSON writer archive that appends straight to a std::string.
+        //
+        // The output is byte for byte what RapidJsonWriterArchive writes, with the rapidjson
+        // write flags the Makefile builds with (NaN and infinities written as NaN, Infinity and
+        // -Infinity). Where rapidjson keeps a stack of levels and checks it on every token, this
+        // archive only needs to know whether a value is the first in its object or array, since
+        // serialize() always writes a key before each member's value.
+        class JsonWriterArchive
+        {
+        public:
+            JsonWriterArchive(std::string &json_, JsonIndent json_indent)
+                : _json(json_), _num_spaces(get_num_spaces(json_indent)),
+                  _indented(json_indent != JsonIndent::compact)
+            {
+                growIndent(8);
+            }
+            void class_version(const int class_version_)
+            {
+                if (class_version_ > 0)
+                {
+                    writeKey("_objver");
+                    writeInt(class_version_);
+                }
+            }
+            template <typename T>
+            void ez(JsonKey key, T t, int /*object_version_supported*/)
+            {
+                ez(key, t);
+            }
+            void ez(JsonKey key, bool b)
+            {
+                writeKey(key);
+                _ez(b);
+            }
+            void ez(JsonKey key, int8_t i8)
+            {
+                writeKey(key);
+                _ez(i8);
+            }
+            void ez(JsonKey key, int16_t i16)
+            {
+                writeKey(key);
+                _ez(i16);
+            }
+            void ez(JsonKey key, int32_t i32)
+            {
+                writeKey(key);
+                _ez(i32);
+            }
+            void ez(JsonKey key, int64_t i64)
+            {
+                writeKey(key);
+                _ez(i64);
+            }
+            void ez(JsonKey key, uint8_t u8)
+            {
+                writeKey(key);
+                _ez(u8);
+            }
+            void ez(JsonKey key, uint16_t u16)
+            {
+                writeKey(key);
+                _ez(u16);
+            }
+            void ez(JsonKey key, uint32_t u32)
+            {
+                writeKey(key);
+                _ez(u32);
+            }
+            void ez(JsonKey key, uint64_t u64)
+            {
+                writeKey(key);
+                _ez(u64);
+            }
+            // Only "double", like RapidJsonWriterArchive, so the same types can be written.
+            // void ez(JsonKey key, float f)
+            void ez(JsonKey key, double d)
+            {
+                writeKey(key);
+                _ez(d);
+            }
+            void ez(JsonKey key, const std::string &s)
+            {
+                writeKey(key);
+                _ez(s);
+            }
+#if EASY_SERIALIZE_HAS_STRING_VIEW
+            void ez(JsonKey key, std::string_view s)
+            {
+                writeKey(key);
+                _ez(s);
+            }
+#endif
+            template <typename T>
+            void ez(JsonKey key, Lazy<T> &lazy)
+            {
+                writeKey(key);
+                _ez_lazy(lazy);
+            }
+            template <typename T>
+            void ez_enum(JsonKey key, T e, T enum_value_N)
+            {
+                writeKey(key);
+                _ez_enum(e, get_enum_names(enum_value_N));
+            }
+            template <typename T>
+            void ez_enum(JsonKey key, T e, T enum_value_N, int /*object_version_supported*/)
+            {
+                ez_enum(key, e, enum_value_N);
+            }
+            template <typename T>
+            void ez_object(JsonKey key, T &o)
+            {
+                writeKey(key);
+                _ez_object(o);
+            }
+            template <typename T>
+            void ez_object(JsonKey key, T t, int /*object_version_supported*/)
+            {
+                ez_object(key, t);
+            }
+            template <typename T>
+            void ez_vector(JsonKey key, std::vector<T> &v)
+            {
+                writeKey(key);
+                _ez_vector(v);
+            }
+            template <typename T>
+            void ez_vector(JsonKey key, std::vector<T> v, int /*object_version_supported*/)
+            {
+                ez_vector(key, v);
+            }
+            template <typename T>
+            void ez_vector_enums(JsonKey key, std::vector<T> &v, T enum_value_N)
+            {
+                writeKey(key);
+                _ez_vector_enums(v, get_enum_names(enum_value_N));
+            }
+            template <typename T>
+            void ez_vector_enums(JsonKey key, std::vector<T> &v, T enum_value_N, int /*object_version_supported*/)
+            {
+                ez_vector_enums(key, v, enum_value_N);
+            }
+            template <typename T>
+            void ez_vector_objects(JsonKey key, std::vector<T> &v)
+            {
+                writeKey(key);
+                _ez_vector_objects(v);
+            }
+            template <typename T>
+            void ez_vector_objects(JsonKey key, std::vector<T> v, int /*object_version_supported*/)
+            {
+                ez_vector_objects(key, v);
+            }
+
+            JsonWriterArchive(const JsonWriterArchive &) = delete;
+            JsonWriterArchive &operator=(const JsonWriterArchive &) = delete;
+
+            template <typename T>
+            friend void to_json_string(T &obj, std::string &json, JsonIndent json_indent);
+            template <typename T>
+            friend void to_json_string_vector_objects(std::vector<T> &v, std::string &json, JsonIndent json_indent);
+            template <typename T>
+            friend void to_json_string_vector_enums(std::vector<T> &v, std::string &json, JsonIndent json_indent);
+            template <typename T>
+            friend void to_json_string_vector_enums(std::vector<T> &v, T enum_value_N, std::string &json,
+                                                    JsonIndent json_indent);
+            template <typename T>
+            friend void to_json_string_vector(std::vector<T> &v, std::string &json, JsonIndent json_indent);
+
+        private:
+            // Indent strings: a newline and the spaces for a depth, all prefixes of one string.
+            void growIndent(size_t depth)
+            {
+                _indent.assign(1 + depth * _num_spaces, ' ');
+                _indent[0] = '\n';
+            }
+            // Start a value in an object or array: a comma after the first, and a new line in
+            // indented JSON.
+            void beginValue()
+            {
+                if (!_first)
+                {
+                    _json.push_back(',');
+                }
+                _first = false;
+                if (_indented)
+                {
+                    newLine();
+                }
+            }
+            void newLine()
+            {
+                const size_t length = 1 + _depth * _num_spaces;
+                if (length > _indent.size())
+                {
+                    growIndent(2 * _depth);
+                }
+                _json.append(_indent.data(), length);
+            }
+            void writeKey(const JsonKey &key)
+            {
+                beginValue();
+                if (key.plain)
+                {
+                    _json.push_back('"');
+                    _json.append(key.name, key.length);
+                    _json.push_back('"');
+                }
+                else
+                {
+                    writeString(key.name, key.length);
+                }
+                if (_indented)
+                {
+                    _json.append(": ", 2);
+                }
+                else
+                {
+                    _json.push_back(':');
+                }
+            }
+            void startContainer(char c)
+            {
+                _json.push_back(c);
+                ++_depth;
+                _first = true;
+            }
+            // Close an object or array, on a new line unless it's empty.
+            void endContainer(char c)
+            {
+                --_depth;
+                if (!_first && _indented)
+                {
+                    newLine();
+                }
+                _json.push_back(c);
+                _first = false;
+            }
+            // Quote and escape a string like rapidjson: quotes, backslashes and control
+            // characters are escaped, everything else (including UTF-8) is copied as it is, a run
+            // at a time.
+            void writeString(const char *s, size_t length)
+            {
+                static const char hex_digits[] = "0123456789ABCDEF";
+                _json.push_back('"');
+                size_t run = 0;
+                for (size_t i = 0; i < length; ++i)
+                {
+                    const auto c = static_cast<unsigned char>(s[i]);
+                    if (c >= 0x20 && c != '"' && c != '\\')
+                    {
+                        continue;
+                    }
+                    _json.append(s + run, i - run);
+                    run = i + 1;
+                    _json.push_back('\\');
+                    switch (c)
+                    {
+                    case '"':
+                    case '\\':
+                        _json.push_back(static_cast<char>(c));
+                        break;
+                    case '\b':
+                        _json.push_back('b');
+                        break;
+                    case '\t':
+                        _json.push_back('t');
+                        break;
+                    case '\n':
+                        _json.push_back('n');
+                        break;
+                    case '\f':
+                        _json.push_back('f');
+                        break;
+                    case '\r':
+                        _json.push_back('r');
+                        break;
+                    default:
+                        _json.append("u00", 3);
+                        _json.push_back(hex_digits[c >> 4]);
+                        _json.push_back(hex_digits[c & 0xF]);
+                        break;
+                    }
+                }
+                _json.append(s + run, length - run);
+                _json.push_back('"');
+            }
+            void writeInt(int64_t i)
+            {
+                char number[max_number_length];
+                _json.append(number, static_cast<size_t>(write_int64(i, number) - number));
+            }
+            void writeUint(uint64_t u)
+            {
+                char number[max_number_length];
+                _json.append(number, static_cast<size_t>(write_uint64(u, number) - number));
+            }
+            void _ez(bool b)
+            {
+                if (b)
+                {
+                    _json.append("true", 4);
+                }
+                else
+                {
+                    _json.append("false", 5);
+                }
+            }
+            void _ez(int8_t i8)
+            {
+                writeInt(i8);
+            }
+            void _ez(int16_t i16)
+            {
+                writeInt(i16);
+            }
+            void _ez(int32_t i32)
+            {
+                writeInt(i32);
+            }
+            void _ez(int64_t i64)
+            {
+                writeInt(i64);
+            }
+            void _ez(uint8_t u8)
+            {
+                writeUint(u8);
+            }
+            void _ez(uint16_t u16)
+            {
+                writeUint(u16);
+            }
+            void _ez(uint32_t u32)
+            {
+                writeUint(u32);
+            }
+            void _ez(uint64_t u64)
+            {
+                writeUint(u64);
+            }
+            void _ez(double d)
+            {
+                if (std::isfinite(d))
+                {
+                    char number[max_number_length];
+                    _json.append(number, static_cast<size_t>(write_double(d, number) - number));
+                }
+                else if (std::isnan(d))
+                {
+                    _json.append("NaN", 3);
+                }
+                else if (d < 0)
+                {
+                    _json.append("-Infinity", 9);
+                }
+                else
+                {
+                    _json.append("Infinity", 8);
+                }
+            }
+            // Up to the first null character, like RapidJsonWriterArchive.
+            void _ez(const std::string &s)
+            {
+                writeString(s.c_str(), std::strlen(s.c_str()));
+            }
+#if EASY_SERIALIZE_HAS_STRING_VIEW
+            void _ez(std::string_view s)
+            {
+                writeString(s.data(), s.size());
+            }
+#endif
+            // Copy out JSON text that hasn't been decoded, as is (it isn't indented).
+            template <typename T>
+            void _ez_lazy(Lazy<T> &lazy)
+            {
+                if (!lazy.is_decoded())
+                {
+                    _json.append(lazy.raw());
+                }
+                else
+                {
+                    _ez_decoded(lazy.get());
+                }
+            }
+            template <typename T>
+            void _ez_decoded(T &o)
+            {
+                _ez_object(o);
+            }
+            template <typename T>
+            void _ez_decoded(std::vector<T> &v)
+            {
+                _ez_vector_objects(v);
+            }
+            template <typename T>
+            void _ez_enum(T &e)
+            {
+                const char *name = to_string(e);
+                writeString(name, std::strlen(name));
+            }
+            template <typename T>
+            void _ez_enum(T e, const EnumNames<T> &names)
+            {
+                if (static_cast<size_t>(e) < names.size())
+                {
+                    writeString(names.name(e), names.length(e));
+                }
+                else
+                {
+                    _ez_enum(e);
+                }
+            }
+            template <typename T>
+            void _ez_object(T &o)
+            {
+                startContainer('{');
+                o.serialize(*this);
+                endContainer('}');
+            }
+            template <typename T>
+            void _ez_vector(std::vector<T> &v)
+            {
+                startContainer('[');
+                for (const auto &t : v)
+                {
+                    beginValue();
+                    _ez(t);
+                }
+                endContainer(']');
+            }
+            template <typename T>
+            void _ez_vector_enums(std::vector<T> &v)
+            {
+                startContainer('[');
+                for (auto e : v)
+                {
+                    beginValue();
+                    _ez_enum(e);
+                }
+                endContainer(']');
+            }
+            template <typename T>
+            void _ez_vector_enums(std::vector<T> &v, const EnumNames<T> &names)
+            {
+                startContainer('[');
+                for (const auto e : v)
+                {
+                    beginValue();
+                    _ez_enum(e, names);
+                }
+                endContainer(']');
+            }
+            template <typename T>
+            void _ez_vector_objects(std::vector<T> &v)
+            {
+                startContainer('[');
+                for (auto &o : v)
+                {
+                    beginValue();
+                    _ez_object(o);
+                }
+                endContainer(']');
+            }
+
+            std::string &_json;
+            const size_t _num_spaces;
+            const bool _indented;
+            // Newline followed by spaces, enough for a few levels.
+            std::string _indent;
+            size_t _depth = 0;
+            // No value written yet in the current object or array.
+            bool _first = true;
+        };
+
+        // Append object UTF-8 JSON to a std::string.
+        //
+        // \param obj: object to write
+        // \param json: string to append to
+        // \param json_indent: JSON indent formatting
+        template <typename T>
+        void to_json_string(T &obj, std::string &json, JsonIndent json_indent)
+        {
+            JsonWriterArchive a(json, json_indent);
+            a._ez_object(obj);
+        }
+
+        // Append vector of objects UTF-8 JSON to a std::string.
+        //
+        // \param v: vector of objects
+        // \param json: string to append to
+        // \param json_indent: JSON indent formatting
+        template <typename T>
+        void to_json_string_vector_objects(std::vector<T> &v, std::string &json, JsonIndent json_indent)
+        {
+            JsonWriterArchive a(json, json_indent);
+            a._ez_vector_objects(v);
+        }
+
+        // Append vector of supported fundamental types UTF-8 JSON to a std::string.
+        //
+        // \param v: vector of supported fundamental types
+        // \param json: string to append to
+        // \param json_indent: JSON indent formatting
+        template <typename T>
+        void to_json_string_vector(std::vector<T> &v, std::string &json, JsonIndent json_indent)
+        {
+            JsonWriterArchive a(json, json_indent);
+            a._ez_vector(v);
+        }
+
+        // Append vector of enums UTF-8 JSON to a std::string.
+        //
+        // \param v: vector of enums
+        // \param json: string to append to
+        // \param json_indent: JSON indent formatting
+        template <typename T>
+        void to_json_string_vector_enums(std::vector<T> &v, std::string &json, JsonIndent json_indent)
+        {
+            JsonWriterArchive a(json, json_indent);
+            a._ez_vector_enums(v);
+        }
+
+        // Append vector of enums UTF-8 JSON to a std::string, using the enum's cached names.
+        //
+        // \param v: vector of enums
+        // \param enum_value_N: last enum value (not a valid value)
+        // \param json: string to append to
+        // \param json_indent: JSON indent formatting
+        template <typename T>
+        void to_json_string_vector_enums(std::vector<T> &v, T enum_value_N, std::string &json,
+                                         JsonIndent json_indent)
+        {
+            JsonWriterArchive a(json, json_indent);
+            a._ez_vector_enums(v, get_enum_names(enum_value_N));
+        }
+    } // namespace native_impl
+} // namespace easy_serialize
@@ -0,0 +1,324 @@
+// easy_serialize fast path for reading JSON arrays of numbers straight from the input bytes.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace easy_serialize
+{
+    namespace rapidjson_impl
+    {
+        // Element types the numeric array scanner reads: the integer types and double.
+        template <typename T>
+        struct IsScannableNumber
+            : std::integral_constant<bool, (std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                            sizeof(T) <= sizeof(int64_t)) ||
+                                               std::is_same<T, double>::value>
+        {
+        };
+
+        // Reads the numbers of a JSON array directly into a std::vector, without a rapidjson value
+        // per element.
+        //
+        // The scanner only accepts numbers it can convert exactly as rapidjson would (with
+        // kParseFullPrecisionFlag) and that the reader archive would accept for the element type.
+        // Anything else (NaN, an out of range value, an integer for a double, a string, malformed
+        // JSON, ...) stops the scan at that element, and rapidjson parses from there, so values and
+        // errors are the same as without the scanner.
+        class NumericArrayScanner
+        {
+        public:
+            // Scan array elements.
+            //
+            // \param p: position just after the array's '['
+            // \param end: end of the input
+            // \param v: vector to append the elements to
+            // \return: where rapidjson should continue, either the start of an element or the ']'
+            //          closing the array. A rapidjson reader that has just read the '[' parses the
+            //          rest of the array correctly from there.
+            template <typename T>
+            static const char *scan(const char *p, const char *end, std::vector<T> &v)
+            {
+                p = skipWhitespace(p, end);
+                if (p == end || *p == ']')
+                {
+                    return p;
+                }
+                for (;;)
+                {
+                    const char *element = p;
+                    T t;
+                    p = parse(p, end, t);
+                    if (!p)
+                    {
+                        return element;
+                    }
+                    p = skipWhitespace(p, end);
+                    if (p != end && *p == ']')
+                    {
+                        v.push_back(t);
+                        return p;
+                    }
+                    if (p == end || *p != ',')
+                    {
+                        // Let rapidjson report what's wrong after the element.
+                        return element;
+                    }
+                    p = skipWhitespace(p + 1, end);
+                    if (p != end && *p == ']')
+                    {
+                        // Trailing comma. Resuming at the ']' would end the array cleanly, so
+                        // resume at the element and let rapidjson report the error.
+                        return element;
+                    }
+                    v.push_back(t);
+                }
+            }
+
+        private:
+            static const char *skipWhitespace(const char *p, const char *end)
+            {
+                while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+                {
+                    ++p;
+                }
+                return p;
+            }
+
+            static bool isDigit(char c)
+            {
+                return c >= '0' && c <= '9';
+            }
+
+            // True if the 8 bytes at p are all digits.
+            static bool isEightDigits(const char *p)
+            {
+                uint64_t val;
+                std::memcpy(&val, p, sizeof(val));
+                return (((val & 0xF0F0F0F0F0F0F0F0) |
+                         (((val + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333);
+            }
+
+            // Value of the 8 digits at p, combining digit pairs, then quads, then octets in a
+            // word (little-endian byte order).
+            static uint64_t parseEightDigits(const char *p)
+            {
+                uint64_t val;
+                std::memcpy(&val, p, sizeof(val));
+                val = ((val & 0x0F0F0F0F0F0F0F0F) * 2561) >> 8;
+                val = ((val & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+                return ((val & 0x0000FFFF0000FFFF) * 42949672960001) >> 32;
+            }
+
+            // Accumulate a run of digits into w, counting them. Stops early (leaving p at a digit)
+            // once more than max_digits have been seen, which the callers treat as too long.
+            static const char *parseDigits(const char *p, const char *end, uint64_t &w, int &num_digits,
+                                           int max_digits)
+            {
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_MSC_VER)
+                while (end - p >= 8 && num_digits + 8 <= max_digits && isEightDigits(p))
+                {
+                    w = w * 100000000 + parseEightDigits(p);
+                    num_digits += 8;
+                    p += 8;
+                }
+#endif
+                while (p != end && isDigit(*p) && num_digits <= max_digits)
+                {
+                    w = w * 10 + static_cast<uint64_t>(*p - '0');
+                    ++num_digits;
+                    ++p;
+                }
+                return p;
+            }
+
+            // Parse an integer element: an optional '-' and digits with no leading zeros, fraction
+            // or exponent, within the range of T.
+            template <typename T>
+            static const char *parse(const char *p, const char *end, T &t)
+            {
+                const bool minus = p != end && *p == '-';
+                if (minus)
+                {
+                    ++p;
+                }
+                if (p == end || !isDigit(*p) || (*p == '0' && end - p > 1 && isDigit(p[1])))
+                {
+                    return nullptr;
+                }
+                // 18 digits always fit in an int64_t.
+                const int max_digits = 18;
+                uint64_t magnitude = 0;
+                int num_digits = 0;
+                p = parseDigits(p, end, magnitude, num_digits, max_digits);
+                if (num_digits > max_digits || (p != end && (isDigit(*p) || *p == '.' || *p == 'e' || *p == 'E')))
+                {
+                    return nullptr;
+                }
+                const int64_t value = minus ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+                if (!inRange<T>(value))
+                {
+                    return nullptr;
+                }
+                t = static_cast<T>(value);
+                return p;
+            }
+
+            template <typename T>
+            static bool inRange(int64_t value)
+            {
+                return std::is_signed<T>::value
+                           ? value >= static_cast<int64_t>(std::numeric_limits<T>::min()) &&
+                                 value <= static_cast<int64_t>(std::numeric_limits<T>::max())
+                           : value >= 0 &&
+                                 static_cast<uint64_t>(value) <= static_cast<uint64_t>(std::numeric_limits<T>::max());
+            }
+
+            // Parse a double element. rapidjson only makes doubles of numbers with a fraction or
+            // exponent, so integers are left to it (the reader reports them as not doubles).
+            // Converts exactly when the significant digits fit in 53 bits and the power of ten is
+            // exact as a double (Clinger's fast path); anything else is left to rapidjson.
+            static const char *parse(const char *p, const char *end, double &d)
+            {
+                const bool minus = p != end && *p == '-';
+                if (minus)
+                {
+                    ++p;
+                }
+                if (p == end || !isDigit(*p) || (*p == '0' && end - p > 1 && isDigit(p[1])))
+                {
+                    return nullptr;
+                }
+                const int max_digits = 19;
+                uint64_t w = 0;
+                int num_digits = 0;
+                // Leading zeros aren't significant.
+                while (p != end && *p == '0')
+                {
+                    ++p;
+                }
+                p = parseDigits(p, end, w, num_digits, max_digits);
+                int exponent = 0;
+                bool has_fraction_or_exponent = false;
+                if (p != end && *p == '.')
+                {
+                    ++p;
+                    if (p == end || !isDigit(*p))
+                    {
+                        return nullptr;
+                    }
+                    has_fraction_or_exponent = true;
+                    const char *fraction = p;
+                    if (num_digits == 0)
+                    {
+                        while (p != end && *p == '0')
+                        {
+                            ++p;
+                        }
+                    }
+                    p = parseDigits(p, end, w, num_digits, max_digits);
+                    exponent = -static_cast<int>(p - fraction);
+                }
+                if (num_digits > max_digits || (p != end && isDigit(*p)))
+                {
+                    return nullptr;
+                }
+                if (p != end && (*p == 'e' || *p == 'E'))
+                {
+                    ++p;
+                    const bool exponent_minus = p != end && *p == '-';
+                    if (p != end && (*p == '-' || *p == '+'))
+                    {
+                        ++p;
+                    }
+                    if (p == end || !isDigit(*p))
+                    {
+                        return nullptr;
+                    }
+                    has_fraction_or_exponent = true;
+                    int e = 0;
+                    while (p != end && isDigit(*p))
+                    {
+                        if (e > 1000)
+                        {
+                            return nullptr;
+                        }
+                        e = e * 10 + (*p - '0');
+                        ++p;
+                    }
+                    exponent += exponent_minus ? -e : e;
+                }
+                if (!has_fraction_or_exponent || w > (uint64_t(1) << 53) || exponent < -22 || exponent > 22)
+                {
+                    return nullptr;
+                }
+                static const double powers_of_ten[] = {
+                    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+                d = static_cast<double>(w);
+                d = exponent < 0 ? d / powers_of_ten[-exponent] : d * powers_of_ten[exponent];
+                if (minus)
+                {
+                    d = -d;
+                }
+                return p;
+            }
+        };
+
+        template <typename T>
+        bool scan_numeric_array_document(const char * /*json*/, size_t /*size*/, std::vector<T> & /*v*/,
+                                         std::false_type /*scannable*/)
+        {
+            return false;
+        }
+        template <typename T>
+        bool scan_numeric_array_document(const char *json, size_t size, std::vector<T> &v,
+                                         std::true_type /*scannable*/)
+        {
+            const char *p = json;
+            const char *end = json + size;
+            if (size >= 3 && static_cast<unsigned char>(p[0]) == 0xEF &&
+                static_cast<unsigned char>(p[1]) == 0xBB && static_cast<unsigned char>(p[2]) == 0xBF)
+            {
+                p += 3;
+            }
+            while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+            {
+                ++p;
+            }
+            if (p == end || *p != '[')
+            {
+                return false;
+            }
+            v.clear();
+            p = NumericArrayScanner::scan(p + 1, end, v);
+            if (p == end || *p != ']')
+            {
+                return false;
+            }
+            ++p;
+            while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+            {
+                ++p;
+            }
+            return p == end;
+        }
+
+        // Read a JSON document that is an array of numbers straight into v, when the scanner can
+        // read every element.
+        //
+        // \param json: buffer of UTF-8 JSON
+        // \param size: size of buffer
+        // \param v: vector to populate
+        // \return: true if v was read; false if the document needs the regular reader (v's
+        //          contents are then unspecified)
+        template <typename T>
+        bool scan_numeric_array_document(const char *json, size_t size, std::vector<T> &v)
+        {
+            return scan_numeric_array_document(json, size, v, IsScannableNumber<T>());
+        }
+    } // namespace rapidjson_impl
+} // namespace easy_serialize
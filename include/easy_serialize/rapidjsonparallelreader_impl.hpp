@@ -0,0 +1,234 @@
+// easy_serialize parallel JSON reader implementation using rapidjson.
+#pragma once
+
+#include "easy_serialize_status.hpp"
+#include "rapidjsonreader_impl.hpp"
+
+#include <rapidjson/memorystream.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace easy_serialize
+{
+    namespace rapidjson_impl
+    {
+        // Number of worker threads to use when the caller asks for 0: one per hardware thread.
+        inline unsigned default_num_threads()
+        {
+            const unsigned n = std::thread::hardware_concurrency();
+            return n > 0 ? n : 1;
+        }
+
+        // Finds the elements of a JSON document that is an array, without parsing them: only
+        // strings and nesting are tracked, so it runs much faster than a parse.
+        class ArrayElementScanner
+        {
+        public:
+            // Find the elements of the top-level array in json.
+            //
+            // \param json: buffer of UTF-8 JSON
+            // \param size: size of buffer
+            // \param elements: set to the [begin, end) of each element's text
+            // \return: false if the document isn't an array the scanner can split (not an array,
+            //          unbalanced or unterminated); a parse gives the exact error
+            static bool scan(const char *json, size_t size,
+                             std::vector<std::pair<const char *, const char *>> &elements)
+            {
+                elements.clear();
+                const char *p = json;
+                const char *end = json + size;
+                if (size >= 3 && static_cast<unsigned char>(p[0]) == 0xEF &&
+                    static_cast<unsigned char>(p[1]) == 0xBB && static_cast<unsigned char>(p[2]) == 0xBF)
+                {
+                    p += 3;
+                }
+                p = skipWhitespace(p, end);
+                if (p == end || *p != '[')
+                {
+                    return false;
+                }
+                p = skipWhitespace(p + 1, end);
+                if (p != end && *p == ']')
+                {
+                    return skipWhitespace(p + 1, end) == end;
+                }
+                for (;;)
+                {
+                    const char *element = p;
+                    p = skipElement(p, end);
+                    if (!p)
+                    {
+                        return false;
+                    }
+                    elements.emplace_back(element, p);
+                    if (*p == ']')
+                    {
+                        return skipWhitespace(p + 1, end) == end;
+                    }
+                    ++p;
+                }
+            }
+
+        private:
+            static const char *skipWhitespace(const char *p, const char *end)
+            {
+                while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+                {
+                    ++p;
+                }
+                return p;
+            }
+
+            // Skip to the ',' or ']' ending the array element at p.
+            //
+            // \return: the ',' or ']', or nullptr if the input ends first or is unbalanced
+            static const char *skipElement(const char *p, const char *end)
+            {
+                int depth = 0;
+                for (; p != end; ++p)
+                {
+                    switch (*p)
+                    {
+                    case '"':
+                        for (++p; p != end && *p != '"'; ++p)
+                        {
+                            if (*p == '\\' && ++p == end)
+                            {
+                                return nullptr;
+                            }
+                        }
+                        if (p == end)
+                        {
+                            return nullptr;
+                        }
+                        break;
+                    case '{':
+                    case '[':
+                        ++depth;
+                        break;
+                    case '}':
+                        if (--depth < 0)
+                        {
+                            return nullptr;
+                        }
+                        break;
+                    case ']':
+                        if (depth == 0)
+                        {
+                            return p;
+                        }
+                        --depth;
+                        break;
+                    case ',':
+                        if (depth == 0)
+                        {
+                            return p;
+                        }
+                        break;
+                    default:
+                        break;
+                    }
+                }
+                return nullptr;
+            }
+        };
+
+        // Populate std::vector of objects with UTF-8 JSON in buffer, reading the array's elements
+        // on several threads.
+        //
+        // The elements are found with ArrayElementScanner, then worker threads take batches of
+        // them, parsing and binding each one separately (with their own memory pools and archive)
+        // into the pre-sized vector. Results and error messages are the same as
+        // from_json_buffer_vector_objects: a binding error reports the lowest failing index, and
+        // if anything doesn't parse, the buffer is read again serially for the parse error.
+        //
+        // \param buffer: buffer of UTF-8 JSON
+        // \param buffer_size: size of buffer
+        // \param v: vector of objects to populate
+        // \param num_threads: number of worker threads, 0 for one per hardware thread
+        // \return: EasySerializeStatus object
+        template <typename T>
+        EasySerializeStatus from_json_buffer_vector_objects_parallel(const char *buffer, size_t buffer_size,
+                                                                     std::vector<T> &v, unsigned num_threads)
+        {
+            std::vector<std::pair<const char *, const char *>> elements;
+            if (!ArrayElementScanner::scan(buffer, buffer_size, elements))
+            {
+                return from_json_buffer_vector_objects(buffer, buffer_size, v);
+            }
+            v.clear();
+            v.resize(elements.size());
+            if (num_threads == 0)
+            {
+                num_threads = default_num_threads();
+            }
+            // Batches are small enough for the threads to finish together when element sizes vary.
+            const size_t batch_size = std::max<size_t>(1, elements.size() / (16 * static_cast<size_t>(num_threads)));
+            std::atomic<size_t> next_batch(0);
+            std::atomic<bool> parse_failed(false);
+            std::mutex error_mutex;
+            size_t error_index = std::numeric_limits<size_t>::max();
+            EasySerializeStatus error_status;
+
+            auto work = [&]()
+            {
+                RapidJsonReaderContext context;
+                RapidJsonReaderArchive a;
+                for (;;)
+                {
+                    const size_t first = next_batch.fetch_add(1) * batch_size;
+                    if (first >= elements.size() || parse_failed)
+                    {
+                        return;
+                    }
+                    const size_t last = std::min(first + batch_size, elements.size());
+                    for (size_t i = first; i < last; ++i)
+                    {
+                        rapidjson::MemoryStream ms(elements[i].first,
+                                                   static_cast<size_t>(elements[i].second - elements[i].first));
+                        const auto &d = context.parse<RAPIDJSON_PARSE_FLAGS>(ms);
+                        if (d.HasParseError())
+                        {
+                            parse_failed = true;
+                            return;
+                        }
+                        EasySerializeStatus status = from_json_document(d, a, v[i]);
+                        if (!status)
+                        {
+                            // Keep parsing the rest: a parse error anywhere beats a binding error.
+                            std::lock_guard<std::mutex> lock(error_mutex);
+                            if (i < error_index)
+                            {
+                                error_index = i;
+                                status.add_error_index(i);
+                                error_status = status;
+                            }
+                        }
+                    }
+                }
+            };
+            std::vector<std::thread> workers;
+            for (unsigned i = 1; i < num_threads; ++i)
+            {
+                workers.emplace_back(work);
+            }
+            work();
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+            if (parse_failed)
+            {
+                return from_json_buffer_vector_objects(buffer, buffer_size, v);
+            }
+            return error_status;
+        }
+    } // namespace rapidjson_impl
+} // namespace easy_serialize
@@ -1,61 +1,174 @@
 // easy_serialize JSON reader implementation using rapidjson.
 #pragma once
 
+#include "easy_serialize_config.hpp"
 #include "easy_serialize_status.hpp"
+#include "enum_names.hpp"
+#include "json_key.hpp"
+#include "rapidjsonnumericarray_impl.hpp"
 
 #include <rapidjson/document.h>
+#include <rapidjson/encodedstream.h>
 #include <rapidjson/error/en.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <limits>
-#include <stdexcept>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace easy_serialize
 {
+    template <typename T>
+    class Lazy;
+
+    // Specialize as std::true_type for a type whose serialize() asks for the same fields every
+    // time it's run, whatever the object holds, to have the DOM reader read it through a schema
+    // recorded once instead of running serialize() for each object:
+    //
+    //     namespace easy_serialize { template <> struct HasFixedFields<Message> : std::true_type {}; }
+    //
+    // Off by default, since a serialize() that skips fields depending on the object's state
+    // (if (kind == X) ar.ez("x", x)) would be recorded with the fields of a default constructed
+    // object, and the others would be silently ignored.
+    template <typename T>
+    struct HasFixedFields : std::false_type
+    {
+    };
+
     namespace rapidjson_impl
     {
+        template <typename InputStream>
+        class RapidJsonStreamReaderArchive;
+
+        class RapidJsonReaderContext;
+
+        class ObjectSchema;
+
+        template <typename T>
+        const ObjectSchema *get_object_schema();
+
+        // Open addressing hash table of the members of an object, by name, for finding members
+        // read out of order without comparing the key with every member name.
+        class MemberIndex
+        {
+        public:
+            // Objects with this many members or fewer are searched member by member.
+            static constexpr rapidjson::SizeType min_members = 8;
+
+            // Index the members of object, reusing the table's memory.
+            void build(const rapidjson::Value &object)
+            {
+                size_t size = 16;
+                while (size < 2 * static_cast<size_t>(object.MemberCount()))
+                {
+                    size *= 2;
+                }
+                _slots.assign(size, Slot());
+                _mask = size - 1;
+                uint32_t member = 0;
+                for (auto it = object.MemberBegin(); it != object.MemberEnd(); ++it)
+                {
+                    const uint32_t hash = hash_key(it->name.GetString(), it->name.GetStringLength());
+                    size_t i = hash & _mask;
+                    while (_slots[i].member != 0)
+                    {
+                        i = (i + 1) & _mask;
+                    }
+                    // Members are numbered from 1, so 0 is an empty slot. A repeated name is found
+                    // at its first member, like rapidjson's FindMember.
+                    _slots[i].hash = hash;
+                    _slots[i].member = ++member;
+                }
+            }
+
+            // Find the first member of object (the object indexed) named key.
+            rapidjson::Value::ConstMemberIterator find(const rapidjson::Value &object, const JsonKey &key) const
+            {
+                for (size_t i = key.hash & _mask; _slots[i].member != 0; i = (i + 1) & _mask)
+                {
+                    if (_slots[i].hash == key.hash)
+                    {
+                        const auto it = object.MemberBegin() + (_slots[i].member - 1);
+                        if (it->name.GetStringLength() == key.length &&
+                            std::memcmp(it->name.GetString(), key.name, key.length) == 0)
+                        {
+                            return it;
+                        }
+                    }
+                }
+                return object.MemberEnd();
+            }
+
+        private:
+            struct Slot
+            {
+                uint32_t hash = 0;
+                uint32_t member = 0;
+            };
+            std::vector<Slot> _slots;
+            size_t _mask = 0;
+        };
+
         // JSON reader archive based on rapidjson.
+        //
+        // std::string_view members point into the document's strings, so they are only allowed
+        // when the caller keeps those alive: parsing in situ (the strings are in the caller's
+        // buffer) or with a RapidJsonReaderContext (the strings are in the context until its next
+        // parse).
+        //
+        // Errors don't throw. The first error is recorded in _status, then every read is skipped
+        // until the top-level object is done, and each level the error passes through on the way
+        // out adds its key or index to the status.
         class RapidJsonReaderArchive
         {
         public:
-            RapidJsonReaderArchive(){};
+            // \param string_views: allow std::string_view members
+            explicit RapidJsonReaderArchive(bool string_views = false) : _string_views(string_views) {}
             void class_version(const int class_version_)
             {
-                const auto it = _stack.back().value->FindMember("_objver");
-                if (it != _stack.back().value->MemberEnd())
+                if (!_status)
                 {
-                    try
-                    {
-                        _ez(it->value, _stack.back().objver);
-                    }
-                    catch (const std::exception &ex)
+                    return;
+                }
+                ValueObjVer &top = _stack.back();
+                const auto it = findKey("_objver");
+                if (it != top.value->MemberEnd())
+                {
+                    if (!_ez(it->value, top.objver))
                     {
-                        throw std::runtime_error(buildErrorKey("_objver") + ex.what());
+                        _status.add_error_key("_objver");
                     }
-                    if (class_version_ < _stack.back().objver)
+                    else if (class_version_ < top.objver)
                     {
-                        throw std::runtime_error(buildErrorKey("_objver") + " object too new");
+                        fail(" object too new");
+                        _status.add_error_key("_objver");
                     }
                 }
                 // else leave objver at zero default.
             }
             template <typename T>
-            void ez(const char *key, T &t)
+            void ez(JsonKey key, T &t)
             {
-                try
+                if (!_status)
                 {
-                    const auto it = checkKey(key);
-                    _ez(it->value, t);
+                    return;
                 }
-                catch (const std::exception &ex)
+                const rapidjson::Value *value = checkKey(key);
+                if (!value || !_ez(*value, t))
                 {
-                    throw std::runtime_error(buildErrorKey(key) + ex.what());
+                    _status.add_error_key(key.name);
                 }
             }
             template <typename T>
-            void ez(const char *key, T &t, int object_version_supported)
+            void ez(JsonKey key, T &t, int object_version_supported)
             {
                 if (object_version_supported > _stack.back().objver)
                 {
@@ -64,19 +177,20 @@ namespace easy_serialize
                 ez(key, t);
             }
             template <typename T>
-            void ez_enum(const char *key, T &e, T enum_value_N)
+            void ez_enum(JsonKey key, T &e, T enum_value_N)
             {
-                try
+                if (!_status)
                 {
-                    _ez_enum(checkKey(key)->value, e, enum_value_N);
+                    return;
                 }
-                catch (const std::exception &ex)
+                const rapidjson::Value *value = checkKey(key);
+                if (!value || !_ez_enum(*value, e, enum_value_N))
                 {
-                    throw std::runtime_error(buildErrorKey(key) + ex.what());
+                    _status.add_error_key(key.name);
                 }
             }
             template <typename T>
-            void ez_enum(const char *key, T &e, T enum_value_N, int object_version_supported)
+            void ez_enum(JsonKey key, T &e, T enum_value_N, int object_version_supported)
             {
                 if (object_version_supported > _stack.back().objver)
                 {
@@ -85,20 +199,20 @@ namespace easy_serialize
                 ez_enum(key, e, enum_value_N);
             }
             template <typename T>
-            void ez_object(const char *key, T &o)
+            void ez_object(JsonKey key, T &o)
             {
-                try
+                if (!_status)
                 {
-                    const auto it = checkKey(key);
-                    _ez_object(it->value, o);
+                    return;
                 }
-                catch (const std::exception &ex)
+                const rapidjson::Value *value = checkKey(key);
+                if (!value || !_ez_object(*value, o))
                 {
-                    throw std::runtime_error(buildErrorKey(key) + ex.what());
+                    _status.add_error_key(key.name);
                 }
             }
             template <typename T>
-            void ez_object(const char *key, T &o, int object_version_supported)
+            void ez_object(JsonKey key, T &o, int object_version_supported)
             {
                 if (object_version_supported > _stack.back().objver)
                 {
@@ -107,19 +221,20 @@ namespace easy_serialize
                 ez_object(key, o);
             }
             template <typename T>
-            void ez_vector(const char *key, std::vector<T> &v)
+            void ez_vector(JsonKey key, std::vector<T> &v)
             {
-                try
+                if (!_status)
                 {
-                    _ez_vector(checkKey(key)->value, v);
+                    return;
                 }
-                catch (const std::exception &ex)
+                const rapidjson::Value *value = checkKey(key);
+                if (!value || !_ez_vector(*value, v))
                 {
-                    throw std::runtime_error(buildErrorKey(key) + ex.what());
+                    _status.add_error_key(key.name);
                 }
             }
             template <typename T>
-            void ez_vector(const char *key, std::vector<T> &v, int object_version_supported)
+            void ez_vector(JsonKey key, std::vector<T> &v, int object_version_supported)
             {
                 if (object_version_supported > _stack.back().objver)
                 {
@@ -128,19 +243,20 @@ namespace easy_serialize
                 ez_vector(key, v);
             }
             template <typename T>
-            void ez_vector_enums(const char *key, std::vector<T> &v, T enum_value_N)
+            void ez_vector_enums(JsonKey key, std::vector<T> &v, T enum_value_N)
             {
-                try
+                if (!_status)
                 {
-                    _ez_vector_enums(checkKey(key)->value, v, enum_value_N);
+                    return;
                 }
-                catch (const std::exception &ex)
+                const rapidjson::Value *value = checkKey(key);
+                if (!value || !_ez_vector_enums(*value, v, enum_value_N))
                 {
-                    throw std::runtime_error(buildErrorKey(key) + ex.what());
+                    _status.add_error_key(key.name);
                 }
             }
             template <typename T>
-            void ez_vector_enums(const char *key, std::vector<T> &v, T enum_value_N, int object_version_supported)
+            void ez_vector_enums(JsonKey key, std::vector<T> &v, T enum_value_N, int object_version_supported)
             {
                 if (object_version_supported > _stack.back().objver)
                 {
@@ -149,19 +265,20 @@ namespace easy_serialize
                 ez_vector_enums(key, v, enum_value_N);
             }
             template <typename T>
-            void ez_vector_objects(const char *key, std::vector<T> &v)
+            void ez_vector_objects(JsonKey key, std::vector<T> &v)
             {
-                try
+                if (!_status)
                 {
-                    _ez_vector_objects(checkKey(key)->value, v);
+                    return;
                 }
-                catch (const std::exception &ex)
+                const rapidjson::Value *value = checkKey(key);
+                if (!value || !_ez_vector_objects(*value, v))
                 {
-                    throw std::runtime_error(buildErrorKey(key) + ex.what());
+                    _status.add_error_key(key.name);
                 }
             }
             template <typename T>
-            void ez_vector_objects(const char *key, std::vector<T> &v, int object_version_supported)
+            void ez_vector_objects(JsonKey key, std::vector<T> &v, int object_version_supported)
             {
                 if (object_version_supported > _stack.back().objver)
                 {
@@ -172,271 +289,1084 @@ namespace easy_serialize
             RapidJsonReaderArchive(const RapidJsonReaderArchive &) = delete;
             RapidJsonReaderArchive &operator=(const RapidJsonReaderArchive &) = delete;
 
-            template <typename BufferPtr, typename T>
-            friend EasySerializeStatus from_json_buffer(BufferPtr buffer_ptr, size_t buffer_size, T &obj);
-
-            template <class BufferPtr, typename T>
-            friend EasySerializeStatus from_json_buffer_vector_objects(BufferPtr buffer_ptr,
-                                                                       size_t buffer_size,
-                                                                       std::vector<T> &v);
-            template <class BufferPtr, typename T>
-            friend EasySerializeStatus from_json_buffer_vector(BufferPtr buffer_ptr,
-                                                               size_t buffer_size,
-                                                               std::vector<T> &v);
-            template <typename BufferPtr, typename T>
-            friend EasySerializeStatus from_json_buffer_vector_enums(BufferPtr buffer_ptr,
-                                                                     size_t buffer_size,
-                                                                     std::vector<T> &v,
-                                                                     T enum_value_N);
+            template <typename Document, typename T>
+            friend EasySerializeStatus from_json_document(const Document &d, RapidJsonReaderArchive &a, T &obj);
+
+            template <typename Document, typename T>
+            friend EasySerializeStatus from_json_document_vector_objects(const Document &d,
+                                                                         RapidJsonReaderArchive &a,
+                                                                         std::vector<T> &v);
+            template <typename Document, typename T>
+            friend EasySerializeStatus from_json_document_vector(const Document &d,
+                                                                 RapidJsonReaderArchive &a,
+                                                                 std::vector<T> &v);
+            template <typename Document, typename T>
+            friend EasySerializeStatus from_json_document_vector_enums(const Document &d,
+                                                                       RapidJsonReaderArchive &a,
+                                                                       std::vector<T> &v,
+                                                                       T enum_value_N);
+
+            // The streaming archive uses the value conversions for tokens and buffered members.
+            template <typename InputStream>
+            friend class RapidJsonStreamReaderArchive;
+
+            friend class RapidJsonReaderContext;
+
+            // Takes the addresses of the bind functions.
+            friend class SchemaArchive;
+            // Binds members one at a time through their schema.
+            friend class SchemaBinder;
 
         private:
-            void _ez(const rapidjson::Value &value, bool &b)
+            bool _ez(const rapidjson::Value &value, bool &b)
             {
                 if (!value.IsBool())
                 {
-                    throw std::runtime_error(" expected a bool");
+                    return fail(" expected a bool");
                 }
                 b = value.GetBool();
+                return true;
             }
-            void _ez(const rapidjson::Value &value, int8_t &i8)
+            bool _ez(const rapidjson::Value &value, int8_t &i8)
             {
                 if (!value.IsInt() ||
                     value.GetInt() < std::numeric_limits<int8_t>::min() ||
                     value.GetInt() > std::numeric_limits<int8_t>::max())
                 {
-                    throw std::runtime_error(" expected an int8");
+                    return fail(" expected an int8");
                 }
                 i8 = static_cast<int8_t>(value.GetInt());
+                return true;
             }
-            void _ez(const rapidjson::Value &value, int16_t &i16)
+            bool _ez(const rapidjson::Value &value, int16_t &i16)
             {
                 if (!value.IsInt() ||
                     value.GetInt() < std::numeric_limits<int16_t>::min() ||
                     value.GetInt() > std::numeric_limits<int16_t>::max())
                 {
-                    throw std::runtime_error(" expected an int16");
+                    return fail(" expected an int16");
                 }
                 i16 = static_cast<int16_t>(value.GetInt());
+                return true;
             }
-            void _ez(const rapidjson::Value &value, int32_t &i32)
+            bool _ez(const rapidjson::Value &value, int32_t &i32)
             {
                 if (!value.IsInt())
                 {
-                    throw std::runtime_error(" expected an int32");
+                    return fail(" expected an int32");
                 }
                 i32 = value.GetInt();
+                return true;
             }
-            void _ez(const rapidjson::Value &value, int64_t &i64)
+            bool _ez(const rapidjson::Value &value, int64_t &i64)
             {
                 if (!value.IsInt64())
                 {
-                    throw std::runtime_error(" expected an int64");
+                    return fail(" expected an int64");
                 }
                 i64 = value.GetInt64();
+                return true;
             }
-            void _ez(const rapidjson::Value &value, uint8_t &u8)
+            bool _ez(const rapidjson::Value &value, uint8_t &u8)
             {
                 if (!value.IsUint() ||
                     value.GetUint() > std::numeric_limits<uint8_t>::max())
                 {
-                    throw std::runtime_error(" expected a uint8");
+                    return fail(" expected a uint8");
                 }
                 u8 = static_cast<uint8_t>(value.GetUint());
+                return true;
             }
-            void _ez(const rapidjson::Value &value, uint16_t &u16)
+            bool _ez(const rapidjson::Value &value, uint16_t &u16)
             {
                 if (!value.IsUint() ||
                     value.GetUint() > std::numeric_limits<uint16_t>::max())
                 {
-                    throw std::runtime_error(" expected a uint16");
+                    return fail(" expected a uint16");
                 }
                 u16 = static_cast<uint16_t>(value.GetUint());
+                return true;
             }
-            void _ez(const rapidjson::Value &value, uint32_t &u32)
+            bool _ez(const rapidjson::Value &value, uint32_t &u32)
             {
                 if (!value.IsUint())
                 {
-                    throw std::runtime_error(" expected a uint32");
+                    return fail(" expected a uint32");
                 }
                 u32 = value.GetUint();
+                return true;
             }
-            void _ez(const rapidjson::Value &value, uint64_t &u64)
+            bool _ez(const rapidjson::Value &value, uint64_t &u64)
             {
                 if (!value.IsUint64())
                 {
-                    throw std::runtime_error(" expected a uint64");
+                    return fail(" expected a uint64");
                 }
                 u64 = value.GetUint64();
+                return true;
             }
             // // Rapidjson doesn't support "float" (only "double"), so leave this out.
-            // void _ez(const rapidjson::Value &value, float &f)
-            void _ez(const rapidjson::Value &value, double &d)
+            // bool _ez(const rapidjson::Value &value, float &f)
+            bool _ez(const rapidjson::Value &value, double &d)
             {
                 if (!value.IsDouble())
                 {
-                    throw std::runtime_error(" expected a double");
+                    return fail(" expected a double");
                 }
                 d = value.GetDouble();
+                return true;
             }
-            void _ez(const rapidjson::Value &value, std::string &s)
+            bool _ez(const rapidjson::Value &value, std::string &s)
             {
                 if (!value.IsString())
                 {
-                    throw std::runtime_error(" expected a string");
+                    return fail(" expected a string");
                 }
                 s = value.GetString();
+                return true;
+            }
+#if EASY_SERIALIZE_HAS_STRING_VIEW
+            bool _ez(const rapidjson::Value &value, std::string_view &s)
+            {
+                if (!_string_views)
+                {
+                    return fail(" std::string_view needs in-situ parsing or a JsonReaderContext");
+                }
+                if (!value.IsString())
+                {
+                    return fail(" expected a string");
+                }
+                s = std::string_view(value.GetString(), value.GetStringLength());
+                return true;
             }
+#endif
+            // Keep the value as compact JSON text, to be decoded when it's used.
             template <typename T>
-            void _ez_object(const rapidjson::Value &value, T &obj)
+            bool _ez(const rapidjson::Value &value, Lazy<T> &lazy)
+            {
+                if (Lazy<T>::is_array ? !value.IsArray() : !value.IsObject())
+                {
+                    return fail(Lazy<T>::is_array ? " expected an array" : " expected an object");
+                }
+                rapidjson::StringBuffer string_buffer;
+                rapidjson::Writer<rapidjson::StringBuffer> writer(string_buffer);
+                value.Accept(writer);
+                lazy.set_raw(string_buffer.GetString(), string_buffer.GetSize());
+                return true;
+            }
+            template <typename T>
+            bool _ez_object(const rapidjson::Value &value, T &obj)
             {
                 if (!value.IsObject())
                 {
-                    throw std::runtime_error(" expected an object");
+                    return fail(" expected an object");
+                }
+                const ObjectSchema *schema = _tables ? get_object_schema<T>() : nullptr;
+                if (schema && bindTable(*schema, value, &obj))
+                {
+                    return true;
                 }
                 _stack.emplace_back(&value, 0);
+                if (_indexes.size() < _stack.size())
+                {
+                    _indexes.resize(_stack.size());
+                }
                 obj.serialize(*this);
                 _stack.pop_back();
+                return static_cast<bool>(_status);
+            }
+            template <typename T>
+            bool _ez_enum(const rapidjson::Value &value, T &e, T enum_value_N)
+            {
+                return _ez_enum(value, e, get_enum_names(enum_value_N));
             }
             template <typename T>
-            void _ez_enum(const rapidjson::Value &value, T &e, T enum_value_N)
+            bool _ez_enum(const rapidjson::Value &value, T &e, const EnumNames<T> &names)
             {
-                std::string s;
-                _ez(value, s);
-                for (int i = 0; i < static_cast<int>(enum_value_N); ++i)
+                if (!value.IsString())
                 {
-                    T t = static_cast<T>(i);
-                    if (s == to_string(t))
-                    {
-                        e = t;
-                        return;
-                    }
+                    return fail(" expected a string");
                 }
-                throw std::runtime_error(" expected an enum type");
+                if (!names.find(value.GetString(), value.GetStringLength(), e))
+                {
+                    return fail(" expected an enum type");
+                }
+                return true;
             }
             template <typename T>
-            void _ez_vector(const rapidjson::Value &value, std::vector<T> &v)
+            bool _ez_vector(const rapidjson::Value &value, std::vector<T> &v)
             {
                 if (!value.IsArray())
                 {
-                    throw std::runtime_error(" expected an array");
+                    return fail(" expected an array");
                 }
-                v.clear();
-                v.reserve(value.Size());
+                resizeVector(v, value.Size());
                 for (rapidjson::SizeType i = 0; i < value.Size(); ++i)
                 {
-                    try
-                    {
-                        T t;
-                        _ez(value[i], t);
-                        v.push_back(t);
-                    }
-                    catch (const std::exception &ex)
+                    if (!_ez_element(value[i], v, i))
                     {
-                        throw std::runtime_error(buildErrorIndex(i) + ex.what());
+                        _status.add_error_index(i);
+                        return false;
                     }
                 }
+                return true;
             }
             template <typename T>
-            void _ez_vector_objects(const rapidjson::Value &value, std::vector<T> &v)
+            bool _ez_vector_objects(const rapidjson::Value &value, std::vector<T> &v)
             {
                 if (!value.IsArray())
                 {
-                    throw std::runtime_error(" expected an array");
+                    return fail(" expected an array");
                 }
-                v.clear();
-                v.reserve(value.Size());
+                resizeVector(v, value.Size());
                 for (rapidjson::SizeType i = 0; i < value.Size(); ++i)
                 {
-                    try
+                    if (!_ez_object(value[i], v[i]))
                     {
-                        T object;
-                        _ez_object(value[i], object);
-                        v.push_back(std::move(object));
-                    }
-                    catch (const std::exception &ex)
-                    {
-                        throw std::runtime_error(buildErrorIndex(i) + ex.what());
+                        _status.add_error_index(i);
+                        return false;
                     }
                 }
+                return true;
             }
             template <typename T>
-            void _ez_vector_enums(const rapidjson::Value &value, std::vector<T> &v, T enum_value_N)
+            bool _ez_vector_enums(const rapidjson::Value &value, std::vector<T> &v, T enum_value_N)
             {
                 if (!value.IsArray())
                 {
-                    throw std::runtime_error(" expected an array");
+                    return fail(" expected an array");
                 }
-                v.clear();
-                v.reserve(value.Size());
+                const EnumNames<T> &names = get_enum_names(enum_value_N);
+                resizeVector(v, value.Size());
                 for (rapidjson::SizeType i = 0; i < value.Size(); ++i)
                 {
-                    try
-                    {
-                        T t;
-                        _ez_enum(value[i], t, enum_value_N);
-                        v.push_back(t);
-                    }
-                    catch (const std::exception &ex)
+                    if (!_ez_enum(value[i], v[i], names))
                     {
-                        throw std::runtime_error(buildErrorIndex(i) + ex.what());
+                        _status.add_error_index(i);
+                        return false;
                     }
                 }
+                return true;
             }
-            rapidjson::Value::ConstMemberIterator checkKey(const char *key)
+            template <typename T>
+            bool _ez_element(const rapidjson::Value &value, std::vector<T> &v, size_t i)
             {
-                const auto it = _stack.back().value->FindMember(key);
-                if (it == _stack.back().value->MemberEnd())
+                return _ez(value, v[i]);
+            }
+            // std::vector<bool> elements can't be bound by reference.
+            bool _ez_element(const rapidjson::Value &value, std::vector<bool> &v, size_t i)
+            {
+                bool b = false;
+                if (!_ez(value, b))
                 {
-                    throw std::runtime_error(" key not found");
+                    return false;
+                }
+                v[i] = b;
+                return true;
+            }
+            // Bind the members of object value to obj through its type's schema, in one pass over
+            // the members instead of one lookup per field.
+            //
+            // \return: false if a member is missing or doesn't bind, or the object version is too
+            //          new. Nothing is reported: serialize() reads the object again for the error,
+            //          and the rest of the document, which is only slower.
+            bool bindTable(const ObjectSchema &schema, const rapidjson::Value &value, void *obj);
+
+            // Bind functions recorded in a type's schema, one for each kind of field.
+            template <typename T>
+            static bool bindValue(RapidJsonReaderArchive &a, const rapidjson::Value &value, void *member,
+                                  int64_t /*enum_value_N*/)
+            {
+                return a._ez(value, *static_cast<T *>(member));
+            }
+            template <typename T>
+            static bool bindEnum(RapidJsonReaderArchive &a, const rapidjson::Value &value, void *member,
+                                 int64_t enum_value_N)
+            {
+                return a._ez_enum(value, *static_cast<T *>(member), static_cast<T>(enum_value_N));
+            }
+            template <typename T>
+            static bool bindObject(RapidJsonReaderArchive &a, const rapidjson::Value &value, void *member,
+                                   int64_t /*enum_value_N*/)
+            {
+                return a._ez_object(value, *static_cast<T *>(member));
+            }
+            template <typename T>
+            static bool bindVector(RapidJsonReaderArchive &a, const rapidjson::Value &value, void *member,
+                                   int64_t /*enum_value_N*/)
+            {
+                return a._ez_vector(value, *static_cast<std::vector<T> *>(member));
+            }
+            template <typename T>
+            static bool bindVectorEnums(RapidJsonReaderArchive &a, const rapidjson::Value &value, void *member,
+                                        int64_t enum_value_N)
+            {
+                return a._ez_vector_enums(value, *static_cast<std::vector<T> *>(member),
+                                          static_cast<T>(enum_value_N));
+            }
+            template <typename T>
+            static bool bindVectorObjects(RapidJsonReaderArchive &a, const rapidjson::Value &value, void *member,
+                                          int64_t /*enum_value_N*/)
+            {
+                return a._ez_vector_objects(value, *static_cast<std::vector<T> *>(member));
+            }
+            // Size v for reading size elements into. Existing elements are kept to be overwritten
+            // (along with the memory they hold) when reusing elements, otherwise v starts over with
+            // default constructed elements.
+            template <typename T>
+            void resizeVector(std::vector<T> &v, size_t size)
+            {
+                if (!_reuse_elements)
+                {
+                    v.clear();
+                }
+                v.resize(size);
+            }
+            // Find the first member of the current object named key. Members are usually read in
+            // the order they were written, so the member after the last one found is tried before
+            // searching them all. Searching a wide object indexes its members by hash, for reading
+            // them in any order.
+            //
+            // The member at the cursor is only taken while every member before it was taken the
+            // same way and none of them (as far as a bit per key hash tells) had the same name, so
+            // a repeated name is read from its first member whichever way it's found, like
+            // FindMember().
+            rapidjson::Value::ConstMemberIterator findKey(const JsonKey &key)
+            {
+                ValueObjVer &top = _stack.back();
+                const uint64_t key_bit = uint64_t(1) << (key.hash & 63);
+                if (top.in_order && !(top.passed & key_bit) && top.next != top.value->MemberEnd() &&
+                    top.next->name.GetStringLength() == key.length &&
+                    std::memcmp(top.next->name.GetString(), key.name, key.length) == 0)
+                {
+                    top.passed |= key_bit;
+                    return top.next++;
+                }
+                rapidjson::Value::ConstMemberIterator it;
+                if (top.value->MemberCount() > MemberIndex::min_members)
+                {
+                    MemberIndex &index = _indexes[_stack.size() - 1];
+                    if (!top.indexed)
+                    {
+                        index.build(*top.value);
+                        top.indexed = true;
+                    }
+                    it = index.find(*top.value, key);
+                }
+                else
+                {
+                    it = top.value->FindMember(
+                        rapidjson::Value(rapidjson::StringRef(key.name, static_cast<rapidjson::SizeType>(key.length))));
+                }
+                if (it != top.value->MemberEnd())
+                {
+                    if (it == top.next)
+                    {
+                        top.passed |= key_bit;
+                    }
+                    else
+                    {
+                        top.in_order = false;
+                    }
+                    top.next = it + 1;
                 }
                 return it;
             }
-            std::string buildErrorKey(const char *key)
+            // Find a member of the current object, or record an error and return nullptr.
+            const rapidjson::Value *checkKey(const JsonKey &key)
             {
-                return std::string("[\"") + key + "\"]";
+                const auto it = findKey(key);
+                if (it == _stack.back().value->MemberEnd())
+                {
+                    fail(" key not found");
+                    return nullptr;
+                }
+                return &it->value;
             }
-            std::string buildErrorIndex(unsigned key)
+            // Record an error. reason must be a string literal.
+            bool fail(const char *reason)
             {
-                return std::string("[") + std::to_string(key) + "]";
+                _status.set_error_reason(reason);
+                return false;
             }
             struct ValueObjVer
             {
-                ValueObjVer(const rapidjson::Value *value_, int objver_) : value(value_), objver(objver_) {}
+                ValueObjVer(const rapidjson::Value *value_, int objver_)
+                    : value(value_), objver(objver_), next(value_->MemberBegin()) {}
                 const rapidjson::Value *value;
                 int objver;
+                // Member expected to be read next.
+                rapidjson::Value::ConstMemberIterator next;
+                // Whether the MemberIndex for this level holds value's members.
+                bool indexed = false;
+                // Whether next has only moved one member at a time from the first, and a bit for the
+                // hash of each member it has passed.
+                bool in_order = true;
+                uint64_t passed = 0;
             };
             std::vector<ValueObjVer> _stack;
+            // Member index for each level of _stack, kept to be reused by the next objects.
+            std::vector<MemberIndex> _indexes;
+            EasySerializeStatus _status;
+            bool _string_views;
+            bool _reuse_elements = false;
+            // Objects are bound through their type's schema until one fails to, then the rest of
+            // the document goes through serialize(), so errors cost the same as before.
+            bool _tables = true;
+            // Fields bound so far, for each object being bound through its schema (a stack).
+            std::vector<char> _bound;
         };
 
-        constexpr int RAPIDJSON_PARSE_FLAGS = rapidjson::kParseValidateEncodingFlag | rapidjson::kParseNanAndInfFlag | rapidjson::kParseFullPrecisionFlag;
+        // Fields of a type, recorded by running its serialize() once, for binding objects of the
+        // type without running serialize() again. See SchemaArchive.
+        class ObjectSchema
+        {
+        public:
+            typedef bool (*BindFunction)(RapidJsonReaderArchive &a, const rapidjson::Value &value, void *member,
+                                         int64_t enum_value_N);
+            struct Field
+            {
+                std::string key;
+                uint32_t hash;
+                // Offset of the member in the object.
+                size_t offset;
+                int object_version_supported;
+                BindFunction bind;
+                // Last value of an enum field (not a valid value).
+                int64_t enum_value_N;
+            };
+            static constexpr size_t npos = static_cast<size_t>(-1);
+
+            std::vector<Field> fields;
+            // The class_version() called, if any.
+            bool has_class_version = false;
+            int class_version = 0;
+            bool has_versioned_fields = false;
 
-        // Populate object with UTF-8 JSON in a buffer.
+            // Index the fields by key, once all are added.
+            void index()
+            {
+                if (fields.size() <= MemberIndex::min_members)
+                {
+                    return;
+                }
+                size_t size = 16;
+                while (size < 2 * fields.size())
+                {
+                    size *= 2;
+                }
+                _slots.assign(size, 0);
+                _mask = size - 1;
+                for (size_t i = 0; i < fields.size(); ++i)
+                {
+                    size_t slot = fields[i].hash & _mask;
+                    while (_slots[slot] != 0)
+                    {
+                        slot = (slot + 1) & _mask;
+                    }
+                    _slots[slot] = static_cast<uint32_t>(i + 1);
+                }
+            }
+
+            // Find the field for a member name. Members are usually in field order, so the field
+            // after the last one found is tried first.
+            //
+            // \param guess: index of the field to try first
+            // \return: index of the field, or npos
+            size_t find(const char *name, size_t length, size_t guess) const
+            {
+                if (guess < fields.size() && matches(fields[guess], name, length))
+                {
+                    return guess;
+                }
+                if (_slots.empty())
+                {
+                    for (size_t i = 0; i < fields.size(); ++i)
+                    {
+                        if (matches(fields[i], name, length))
+                        {
+                            return i;
+                        }
+                    }
+                    return npos;
+                }
+                const uint32_t hash = hash_key(name, length);
+                for (size_t slot = hash & _mask; _slots[slot] != 0; slot = (slot + 1) & _mask)
+                {
+                    const Field &field = fields[_slots[slot] - 1];
+                    if (field.hash == hash && matches(field, name, length))
+                    {
+                        return _slots[slot] - 1;
+                    }
+                }
+                return npos;
+            }
+
+            // Number of fields read from an object of version objver.
+            size_t numFields(int objver) const
+            {
+                if (!has_versioned_fields)
+                {
+                    return fields.size();
+                }
+                size_t n = 0;
+                for (const auto &field : fields)
+                {
+                    n += field.object_version_supported <= objver ? 1 : 0;
+                }
+                return n;
+            }
+
+        private:
+            static bool matches(const Field &field, const char *name, size_t length)
+            {
+                return field.key.size() == length && std::memcmp(field.key.data(), name, length) == 0;
+            }
+
+            // Field index + 1 by key hash, 0 for an empty slot. Empty for few fields.
+            std::vector<uint32_t> _slots;
+            size_t _mask = 0;
+        };
+
+        // Archive that runs a type's serialize() on a default constructed object to record its
+        // schema: each field's key, kind, version and offset in the object. Only used for types
+        // that opt in with HasFixedFields.
         //
-        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
-        // \param buffer_size: size of buffer
+        // Types whose serialize() binds something outside the object (like the elements of a
+        // std::vector member), uses a key twice or calls class_version() after a field don't get
+        // a schema, and are always read with serialize().
+        class SchemaArchive
+        {
+        public:
+            SchemaArchive(ObjectSchema &schema, const void *obj, size_t size)
+                : _schema(schema), _obj(static_cast<const char *>(obj)), _size(size) {}
+            void class_version(const int class_version_)
+            {
+                _valid = _valid && _schema.fields.empty() && !_schema.has_class_version;
+                _schema.has_class_version = true;
+                _schema.class_version = class_version_;
+            }
+            template <typename T>
+            void ez(JsonKey key, T &t, int object_version_supported = 0)
+            {
+                add(key, &t, sizeof(t), object_version_supported, &RapidJsonReaderArchive::bindValue<T>, 0);
+            }
+            template <typename T>
+            void ez_enum(JsonKey key, T &e, T enum_value_N, int object_version_supported = 0)
+            {
+                add(key, &e, sizeof(e), object_version_supported, &RapidJsonReaderArchive::bindEnum<T>,
+                    static_cast<int64_t>(enum_value_N));
+            }
+            template <typename T>
+            void ez_object(JsonKey key, T &o, int object_version_supported = 0)
+            {
+                add(key, &o, sizeof(o), object_version_supported, &RapidJsonReaderArchive::bindObject<T>, 0);
+            }
+            template <typename T>
+            void ez_vector(JsonKey key, std::vector<T> &v, int object_version_supported = 0)
+            {
+                add(key, &v, sizeof(v), object_version_supported, &RapidJsonReaderArchive::bindVector<T>, 0);
+            }
+            template <typename T>
+            void ez_vector_enums(JsonKey key, std::vector<T> &v, T enum_value_N, int object_version_supported = 0)
+            {
+                add(key, &v, sizeof(v), object_version_supported, &RapidJsonReaderArchive::bindVectorEnums<T>,
+                    static_cast<int64_t>(enum_value_N));
+            }
+            template <typename T>
+            void ez_vector_objects(JsonKey key, std::vector<T> &v, int object_version_supported = 0)
+            {
+                add(key, &v, sizeof(v), object_version_supported, &RapidJsonReaderArchive::bindVectorObjects<T>, 0);
+            }
+
+            // \return: false if the type can't be bound through its schema
+            bool valid() const { return _valid; }
+
+        private:
+            void add(const JsonKey &key, const void *member, size_t member_size, int object_version_supported,
+                     ObjectSchema::BindFunction bind, int64_t enum_value_N)
+            {
+                const char *m = static_cast<const char *>(member);
+                if (m < _obj || m + member_size > _obj + _size ||
+                    _schema.find(key.name, key.length, ObjectSchema::npos) != ObjectSchema::npos)
+                {
+                    _valid = false;
+                    return;
+                }
+                _schema.fields.push_back({std::string(key.name, key.length), key.hash, static_cast<size_t>(m - _obj),
+                                          object_version_supported, bind, enum_value_N});
+                _schema.has_versioned_fields = _schema.has_versioned_fields || object_version_supported > 0;
+            }
+
+            ObjectSchema &_schema;
+            const char *_obj;
+            size_t _size;
+            bool _valid = true;
+        };
+
+        template <typename T>
+        const ObjectSchema *make_object_schema(ObjectSchema &schema, std::true_type /*fixed_fields*/)
+        {
+            T t;
+            SchemaArchive a(schema, &t, sizeof(t));
+            t.serialize(a);
+            schema.index();
+            return a.valid() ? &schema : nullptr;
+        }
+        template <typename T>
+        const ObjectSchema *make_object_schema(ObjectSchema & /*schema*/, std::false_type /*fixed_fields*/)
+        {
+            return nullptr;
+        }
+
+        // Get the schema of type T, recording it on the first call.
+        //
+        // \return: schema shared by all calls for type T, or nullptr if T is read with serialize()
+        template <typename T>
+        const ObjectSchema *get_object_schema()
+        {
+            typedef std::integral_constant<bool, HasFixedFields<T>::value && std::is_default_constructible<T>::value>
+                FixedFields;
+            static ObjectSchema schema;
+            static const ObjectSchema *const result = make_object_schema<T>(schema, FixedFields());
+            return result;
+        }
+
+        inline bool RapidJsonReaderArchive::bindTable(const ObjectSchema &schema, const rapidjson::Value &value,
+                                                      void *obj)
+        {
+            int objver = 0;
+            if (schema.has_class_version)
+            {
+                const auto it = value.FindMember("_objver");
+                if (it != value.MemberEnd() && (!_ez(it->value, objver) || schema.class_version < objver))
+                {
+                    _status = EasySerializeStatus();
+                    _tables = false;
+                    return false;
+                }
+            }
+            const size_t base = _bound.size();
+            _bound.resize(base + schema.fields.size(), 0);
+            size_t num_bound = 0;
+            size_t next = 0;
+            bool ok = true;
+            for (auto it = value.MemberBegin(); ok && it != value.MemberEnd(); ++it)
+            {
+                const size_t i = schema.find(it->name.GetString(), it->name.GetStringLength(), next);
+                if (i == ObjectSchema::npos)
+                {
+                    continue;
+                }
+                next = i + 1;
+                const ObjectSchema::Field &field = schema.fields[i];
+                // The first of repeated members is read, like FindMember().
+                if (_bound[base + i] || field.object_version_supported > objver)
+                {
+                    continue;
+                }
+                _bound[base + i] = 1;
+                ++num_bound;
+                ok = field.bind(*this, it->value, static_cast<char *>(obj) + field.offset, field.enum_value_N);
+            }
+            _bound.resize(base);
+            if (ok && num_bound == schema.numFields(objver))
+            {
+                return true;
+            }
+            _status = EasySerializeStatus();
+            _tables = false;
+            return false;
+        }
+
+        // Binds the members of an object through its type's schema one at a time, as each is read,
+        // so the object's values needn't be kept until it ends. Errors are the ones serialize()
+        // would report: the first field, in serialize() order, that is missing or doesn't bind.
+        //
+        // Only for schemas without versioned fields, whose fields can't be bound until the
+        // object's "_objver" has been read.
+        class SchemaBinder
+        {
+        public:
+            // \return: true if objects with schema can be bound a member at a time
+            static bool supports(const ObjectSchema *schema) { return schema && !schema->has_versioned_fields; }
+
+            // Start binding an object.
+            //
+            // \param schema: schema of the object's type, which supports() accepts
+            // \param a: archive to bind with
+            // \param obj: object to populate
+            void start(const ObjectSchema &schema, RapidJsonReaderArchive &a, void *obj)
+            {
+                _schema = &schema;
+                _archive = &a;
+                _obj = static_cast<char *>(obj);
+                _bound.assign(schema.fields.size(), 0);
+                _next = 0;
+                _objver_read = false;
+                _error_field = ObjectSchema::npos;
+                _status = EasySerializeStatus();
+                a._stack.clear();
+                a._status = EasySerializeStatus();
+                a._tables = true;
+            }
+
+            // Bind the next member of the object. Members that aren't fields are ignored, and so
+            // is a member whose field was already read, like FindMember().
+            void member(const char *name, size_t length, const rapidjson::Value &value)
+            {
+                if (_schema->has_class_version && length == 7 && std::memcmp(name, "_objver", 7) == 0)
+                {
+                    readObjver(value);
+                    return;
+                }
+                const size_t i = _schema->find(name, length, _next);
+                if (i == ObjectSchema::npos)
+                {
+                    return;
+                }
+                _next = i + 1;
+                // serialize() stops at the first error, so fields after it aren't read.
+                if (_bound[i] || i > _error_field)
+                {
+                    return;
+                }
+                _bound[i] = 1;
+                const ObjectSchema::Field &field = _schema->fields[i];
+                if (!field.bind(*_archive, value, _obj + field.offset, field.enum_value_N))
+                {
+                    _error_field = i;
+                    _status = _archive->_status;
+                    _status.add_error_key(field.key.c_str());
+                    _archive->_status = EasySerializeStatus();
+                }
+            }
+
+            // End the object.
+            //
+            // \return: EasySerializeStatus object
+            EasySerializeStatus finish() const
+            {
+                if (_error_field == error_objver)
+                {
+                    return _status;
+                }
+                for (size_t i = 0; i < _bound.size() && i < _error_field; ++i)
+                {
+                    if (!_bound[i])
+                    {
+                        EasySerializeStatus status;
+                        status.set_error_reason(" key not found");
+                        status.add_error_key(_schema->fields[i].key.c_str());
+                        return status;
+                    }
+                }
+                return _status;
+            }
+
+        private:
+            // _error_field when "_objver" is bad or too new, which serialize() reads before any field.
+            static constexpr size_t error_objver = ObjectSchema::npos - 1;
+
+            // Check the object version, the first "_objver" member, like class_version().
+            void readObjver(const rapidjson::Value &value)
+            {
+                if (_objver_read || _error_field == error_objver)
+                {
+                    return;
+                }
+                _objver_read = true;
+                int objver = 0;
+                bool ok = _archive->_ez(value, objver);
+                if (ok && _schema->class_version < objver)
+                {
+                    ok = _archive->fail(" object too new");
+                }
+                if (!ok)
+                {
+                    _error_field = error_objver;
+                    _status = _archive->_status;
+                    _status.add_error_key("_objver");
+                    _archive->_status = EasySerializeStatus();
+                }
+            }
+
+            const ObjectSchema *_schema = nullptr;
+            RapidJsonReaderArchive *_archive = nullptr;
+            char *_obj = nullptr;
+            // Whether each field has been read.
+            std::vector<char> _bound;
+            // Field after the last one read, tried first for the next member.
+            size_t _next = 0;
+            bool _objver_read = false;
+            // The first field, in serialize() order, that didn't bind, or error_objver, or npos.
+            size_t _error_field = ObjectSchema::npos;
+            // The error for _error_field.
+            EasySerializeStatus _status;
+        };
+
+        constexpr int RAPIDJSON_PARSE_FLAGS = rapidjson::kParseValidateEncodingFlag |
+                                              rapidjson::kParseNanAndInfFlag |
+                                              rapidjson::kParseFullPrecisionFlag;
+
+        // Input stream for in-situ parsing of a caller-owned buffer. Like rapidjson's
+        // InsituStringStream, but bounded by a size instead of needing a null terminator.
+        class InsituBufferStream
+        {
+        public:
+            typedef char Ch;
+
+            InsituBufferStream(char *buffer, size_t buffer_size)
+                : _src(buffer), _dst(nullptr), _head(buffer), _end(buffer + buffer_size)
+            {
+                // Skip a UTF-8 BOM, like rapidjson does for Parse(str, length).
+                if (buffer_size >= 3 && static_cast<unsigned char>(_src[0]) == 0xEFu &&
+                    static_cast<unsigned char>(_src[1]) == 0xBBu && static_cast<unsigned char>(_src[2]) == 0xBFu)
+                {
+                    _src += 3;
+                }
+            }
+
+            Ch Peek() const { return _src == _end ? '\0' : *_src; }
+            Ch Take() { return _src == _end ? '\0' : *_src++; }
+            size_t Tell() const { return static_cast<size_t>(_src - _head); }
+
+            // Decoded strings are written back over the source, which is always at or ahead of _dst.
+            Ch *PutBegin() { return _dst = _src; }
+            void Put(Ch c) { *_dst++ = c; }
+            void Flush() {}
+            size_t PutEnd(Ch *begin) { return static_cast<size_t>(_dst - begin); }
+            Ch *Push(size_t count)
+            {
+                Ch *begin = _dst;
+                _dst += count;
+                return begin;
+            }
+            void Pop(size_t count) { _dst -= count; }
+
+        private:
+            Ch *_src;
+            Ch *_dst;
+            Ch *_head;
+            Ch *_end;
+        };
+
+        // Memory pool over a reusable buffer. The buffer grows to fit the largest parse seen, after
+        // which resetting the pool never touches the heap.
+        class ReusableMemoryPool
+        {
+        public:
+            typedef rapidjson::MemoryPoolAllocator<> Allocator;
+
+            explicit ReusableMemoryPool(size_t capacity) : _buffer(capacity) {}
+
+            // True if everything allocated since the last rebuild() fit in the buffer (or nothing
+            // has been parsed yet).
+            bool fits() const { return _allocator && peak() <= _buffer.size(); }
+
+            // Free everything allocated from the pool, keeping the buffer.
+            void clear()
+            {
+                _peak = peak();
+                _allocator->Clear();
+            }
+
+            // Recreate the allocator, growing the buffer if the last parse didn't fit.
+            // Anything holding the old allocator must be destroyed first.
+            Allocator *rebuild()
+            {
+                if (_allocator && peak() > _buffer.size())
+                {
+                    std::vector<char>(std::max(_buffer.size() * 2, peak())).swap(_buffer);
+                }
+                _peak = 0;
+                _allocator.reset(new Allocator(_buffer.data(), _buffer.size()));
+                return _allocator.get();
+            }
+            Allocator *allocator() { return _allocator.get(); }
+
+            // Bytes held by the pool: the buffer, and any chunks allocated past it.
+            size_t capacity() const
+            {
+                return _allocator ? std::max(_buffer.size(), peak()) : _buffer.size();
+            }
+
+        private:
+            // Most memory the allocator has held since the last rebuild().
+            size_t peak() const { return std::max(_peak, _allocator->Capacity()); }
+
+            std::vector<char> _buffer;
+            std::unique_ptr<Allocator> _allocator;
+            size_t _peak = 0;
+        };
+
+        // Reusable state for reading JSON with a rapidjson document: memory pools for the
+        // document's values and parse stack, and the archive's stack. Memory is kept between
+        // calls, so once warmed up a read does no heap allocations of its own (the object's
+        // strings and vectors still allocate).
+        //
+        // Not thread safe. Keep one per thread.
+        class RapidJsonReaderContext
+        {
+        public:
+            typedef rapidjson::GenericDocument<rapidjson::UTF8<>, ReusableMemoryPool::Allocator,
+                                               ReusableMemoryPool::Allocator>
+                Document;
+
+            // \param initial_capacity: bytes reserved up front for each of the memory pools
+            explicit RapidJsonReaderContext(size_t initial_capacity = 64 * 1024)
+                : _values(initial_capacity), _stack(initial_capacity), _archive(true) {}
+
+            RapidJsonReaderContext(const RapidJsonReaderContext &) = delete;
+            RapidJsonReaderContext &operator=(const RapidJsonReaderContext &) = delete;
+
+            // Parse UTF-8 JSON into the context's document. Invalidates the previous document.
+            template <unsigned parseFlags, typename InputStream>
+            const Document &parse(InputStream &is)
+            {
+                if (_document && _values.fits() && _stack.fits())
+                {
+                    // Each parse frees the document's parse stack and its reader's stack when it's
+                    // done, which a memory pool doesn't reclaim, so _stack is cleared too (nothing
+                    // in it is in use between parses).
+                    _document->SetNull();
+                    _values.clear();
+                    _stack.clear();
+                }
+                else
+                {
+                    _document.reset();
+                    ReusableMemoryPool::Allocator *values_allocator = _values.rebuild();
+                    ReusableMemoryPool::Allocator *stack_allocator = _stack.rebuild();
+                    _document.reset(new Document(values_allocator, 1024, stack_allocator));
+                }
+                _document->template ParseStream<parseFlags, rapidjson::UTF8<>>(is);
+                return *_document;
+            }
+            RapidJsonReaderArchive &archive() { return _archive; }
+
+            // Bytes held by the memory pools, which stop growing once the context has read its
+            // largest message.
+            size_t capacity() const { return _values.capacity() + _stack.capacity(); }
+
+            // Read arrays into the existing elements of vectors instead of new ones, growing or
+            // truncating the vectors to fit. Elements keep the memory held by their strings and
+            // vectors, so reading the same shape of message into the same object again doesn't
+            // allocate. Members that aren't read (e.g. newer than the JSON's object version) keep
+            // their old values rather than defaults. Off by default.
+            void set_reuse_vector_elements(bool reuse) { _archive._reuse_elements = reuse; }
+
+        private:
+            ReusableMemoryPool _values;
+            ReusableMemoryPool _stack;
+            std::unique_ptr<Document> _document;
+            RapidJsonReaderArchive _archive;
+        };
+
+        // Populate object from a parsed rapidjson document.
+        //
+        // \param d: parsed document (its parse error, if any, is reported)
+        // \param a: archive to bind with
         // \param obj: object to populate
         // \return: EasySerializeStatus object
-        template <typename BufferPtr, typename T>
-        EasySerializeStatus from_json_buffer(BufferPtr buffer_ptr, size_t buffer_size, T &obj)
+        template <typename Document, typename T>
+        EasySerializeStatus from_json_document(const Document &d, RapidJsonReaderArchive &a, T &obj)
         {
             EasySerializeStatus status;
-            rapidjson::Document _d;
-            _d.Parse<RAPIDJSON_PARSE_FLAGS>(buffer_ptr, buffer_size);
-            if (_d.HasParseError())
+            if (d.HasParseError())
             {
-                status.set_error_message(rapidjson::GetParseError_En(_d.GetParseError()));
+                status.set_error_message(rapidjson::GetParseError_En(d.GetParseError()));
                 return status;
             }
-            try
+            a._stack.clear();
+            a._status = EasySerializeStatus();
+            a._tables = true;
+            a._ez_object(d, obj);
+            return a._status;
+        }
+
+        // Populate std::vector of objects from a parsed rapidjson document.
+        //
+        // \param d: parsed document (its parse error, if any, is reported)
+        // \param a: archive to bind with
+        // \param v: vector of objects to populate
+        // \return: EasySerializeStatus object
+        template <typename Document, typename T>
+        EasySerializeStatus from_json_document_vector_objects(const Document &d, RapidJsonReaderArchive &a,
+                                                              std::vector<T> &v)
+        {
+            EasySerializeStatus status;
+            if (d.HasParseError())
             {
-                RapidJsonReaderArchive a;
-                a._ez_object(_d, obj);
+                status.set_error_message(rapidjson::GetParseError_En(d.GetParseError()));
+                return status;
             }
-            catch (const std::exception &ex)
+            a._stack.clear();
+            a._status = EasySerializeStatus();
+            a._tables = true;
+            a._ez_vector_objects(d, v);
+            return a._status;
+        }
+
+        // Populate std::vector of primitive types from a parsed rapidjson document.
+        //
+        // \param d: parsed document (its parse error, if any, is reported)
+        // \param a: archive to bind with
+        // \param v: vector of primitive types to populate
+        // \return: EasySerializeStatus object
+        template <typename Document, typename T>
+        EasySerializeStatus from_json_document_vector(const Document &d, RapidJsonReaderArchive &a, std::vector<T> &v)
+        {
+            EasySerializeStatus status;
+            if (d.HasParseError())
+            {
+                status.set_error_message(rapidjson::GetParseError_En(d.GetParseError()));
+                return status;
+            }
+            a._stack.clear();
+            a._status = EasySerializeStatus();
+            a._tables = true;
+            a._ez_vector(d, v);
+            return a._status;
+        }
+
+        // Populate std::vector of enums from a parsed rapidjson document.
+        //
+        // \param d: parsed document (its parse error, if any, is reported)
+        // \param a: archive to bind with
+        // \param v: vector of enums to populate
+        // \param enum_value_N: Last enum value (not a valid enum)
+        // \return: EasySerializeStatus object
+        template <typename Document, typename T>
+        EasySerializeStatus from_json_document_vector_enums(const Document &d, RapidJsonReaderArchive &a,
+                                                            std::vector<T> &v, T enum_value_N)
+        {
+            EasySerializeStatus status;
+            if (d.HasParseError())
             {
-                status.set_error_message(ex.what());
+                status.set_error_message(rapidjson::GetParseError_En(d.GetParseError()));
+                return status;
             }
-            return status;
+            a._stack.clear();
+            a._status = EasySerializeStatus();
+            a._tables = true;
+            a._ez_vector_enums(d, v, enum_value_N);
+            return a._status;
+        }
+
+        // Populate object with UTF-8 JSON in a buffer.
+        //
+        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
+        // \param buffer_size: size of buffer
+        // \param obj: object to populate
+        // \return: EasySerializeStatus object
+        template <typename BufferPtr, typename T>
+        EasySerializeStatus from_json_buffer(BufferPtr buffer_ptr, size_t buffer_size, T &obj)
+        {
+            rapidjson::Document _d;
+            _d.Parse<RAPIDJSON_PARSE_FLAGS>(buffer_ptr, buffer_size);
+            RapidJsonReaderArchive a;
+            return from_json_document(_d, a, obj);
         }
 
         // Populate std::vector of objects with UTF-8 JSON in buffer.
@@ -450,24 +1380,10 @@ namespace easy_serialize
                                                             size_t buffer_size,
                                                             std::vector<T> &v)
         {
-            EasySerializeStatus status;
             rapidjson::Document _d;
             _d.Parse<RAPIDJSON_PARSE_FLAGS>(buffer_ptr, buffer_size);
-            if (_d.HasParseError())
-            {
-                status.set_error_message(rapidjson::GetParseError_En(_d.GetParseError()));
-                return status;
-            }
-            try
-            {
-                RapidJsonReaderArchive a;
-                a._ez_vector_objects(_d, v);
-            }
-            catch (const std::exception &ex)
-            {
-                status.set_error_message(ex.what());
-            }
-            return status;
+            RapidJsonReaderArchive a;
+            return from_json_document_vector_objects(_d, a, v);
         }
 
         // Populate std::vector of primitive types with UTF-8 JSON in buffer.
@@ -479,24 +1395,14 @@ namespace easy_serialize
         template <typename BufferPtr, typename T>
         EasySerializeStatus from_json_buffer_vector(BufferPtr buffer_ptr, size_t buffer_size, std::vector<T> &v)
         {
-            EasySerializeStatus status;
-            rapidjson::Document _d;
-            _d.Parse<RAPIDJSON_PARSE_FLAGS>(buffer_ptr, buffer_size);
-            if (_d.HasParseError())
+            if (scan_numeric_array_document(buffer_ptr, buffer_size, v))
             {
-                status.set_error_message(rapidjson::GetParseError_En(_d.GetParseError()));
-                return status;
+                return EasySerializeStatus();
             }
-            try
-            {
-                RapidJsonReaderArchive a;
-                a._ez_vector(_d, v);
-            }
-            catch (const std::exception &ex)
-            {
-                status.set_error_message(ex.what());
-            }
-            return status;
+            rapidjson::Document _d;
+            _d.Parse<RAPIDJSON_PARSE_FLAGS>(buffer_ptr, buffer_size);
+            RapidJsonReaderArchive a;
+            return from_json_document_vector(_d, a, v);
         }
 
         // Populate std::vector of enums with UTF-8 JSON in buffer.
@@ -515,24 +1421,230 @@ namespace easy_serialize
         EasySerializeStatus from_json_buffer_vector_enums(BufferPtr buffer_ptr, size_t buffer_size,
                                                           std::vector<T> &v, T enum_value_N)
         {
-            EasySerializeStatus status;
             rapidjson::Document _d;
             _d.Parse<RAPIDJSON_PARSE_FLAGS>(buffer_ptr, buffer_size);
-            if (_d.HasParseError())
+            RapidJsonReaderArchive a;
+            return from_json_document_vector_enums(_d, a, v, enum_value_N);
+        }
+
+        // Populate object with UTF-8 JSON in a mutable buffer, parsing in place. Strings are
+        // decoded over the buffer contents, so the buffer is garbage afterwards.
+        //
+        // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+        // \param buffer_size: size of buffer
+        // \param obj: object to populate
+        // \return: EasySerializeStatus object
+        template <typename T>
+        EasySerializeStatus from_json_buffer_insitu(char *buffer, size_t buffer_size, T &obj)
+        {
+            rapidjson::Document _d;
+            InsituBufferStream is(buffer, buffer_size);
+            _d.ParseStream<RAPIDJSON_PARSE_FLAGS | rapidjson::kParseInsituFlag, rapidjson::UTF8<>>(is);
+            RapidJsonReaderArchive a(true);
+            return from_json_document(_d, a, obj);
+        }
+
+        // Populate std::vector of objects with UTF-8 JSON in a mutable buffer, parsing in place.
+        //
+        // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+        // \param buffer_size: size of buffer
+        // \param v: vector of objects to populate
+        // \return: EasySerializeStatus object
+        template <typename T>
+        EasySerializeStatus from_json_buffer_vector_objects_insitu(char *buffer, size_t buffer_size,
+                                                                   std::vector<T> &v)
+        {
+            rapidjson::Document _d;
+            InsituBufferStream is(buffer, buffer_size);
+            _d.ParseStream<RAPIDJSON_PARSE_FLAGS | rapidjson::kParseInsituFlag, rapidjson::UTF8<>>(is);
+            RapidJsonReaderArchive a(true);
+            return from_json_document_vector_objects(_d, a, v);
+        }
+
+        // Populate std::vector of primitive types with UTF-8 JSON in a mutable buffer, parsing in
+        // place.
+        //
+        // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+        // \param buffer_size: size of buffer
+        // \param v: vector of primitive types to populate
+        // \return: EasySerializeStatus object
+        template <typename T>
+        EasySerializeStatus from_json_buffer_vector_insitu(char *buffer, size_t buffer_size, std::vector<T> &v)
+        {
+            if (scan_numeric_array_document(buffer, buffer_size, v))
             {
-                status.set_error_message(rapidjson::GetParseError_En(_d.GetParseError()));
-                return status;
+                return EasySerializeStatus();
             }
-            try
+            rapidjson::Document _d;
+            InsituBufferStream is(buffer, buffer_size);
+            _d.ParseStream<RAPIDJSON_PARSE_FLAGS | rapidjson::kParseInsituFlag, rapidjson::UTF8<>>(is);
+            RapidJsonReaderArchive a(true);
+            return from_json_document_vector(_d, a, v);
+        }
+
+        // Populate std::vector of enums with UTF-8 JSON in a mutable buffer, parsing in place.
+        //
+        // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+        // \param buffer_size: size of buffer
+        // \param v: vector of enums to populate
+        // \param enum_value_N: Last enum value (not a valid enum)
+        // \return: EasySerializeStatus object
+        template <typename T>
+        EasySerializeStatus from_json_buffer_vector_enums_insitu(char *buffer, size_t buffer_size,
+                                                                 std::vector<T> &v, T enum_value_N)
+        {
+            rapidjson::Document _d;
+            InsituBufferStream is(buffer, buffer_size);
+            _d.ParseStream<RAPIDJSON_PARSE_FLAGS | rapidjson::kParseInsituFlag, rapidjson::UTF8<>>(is);
+            RapidJsonReaderArchive a(true);
+            return from_json_document_vector_enums(_d, a, v, enum_value_N);
+        }
+
+        // Populate object with UTF-8 JSON in a buffer, reusing the memory in context.
+        //
+        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
+        // \param buffer_size: size of buffer
+        // \param obj: object to populate
+        // \param context: reader state kept between calls
+        // \return: EasySerializeStatus object
+        template <typename BufferPtr, typename T>
+        EasySerializeStatus from_json_buffer(BufferPtr buffer_ptr, size_t buffer_size, T &obj,
+                                             RapidJsonReaderContext &context)
+        {
+            rapidjson::MemoryStream ms(buffer_ptr, buffer_size);
+            rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream> is(ms);
+            return from_json_document(context.parse<RAPIDJSON_PARSE_FLAGS>(is), context.archive(), obj);
+        }
+
+        // Populate std::vector of objects with UTF-8 JSON in buffer, reusing the memory in context.
+        //
+        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
+        // \param buffer_size: size of buffer
+        // \param v: vector of objects to populate
+        // \param context: reader state kept between calls
+        // \return: EasySerializeStatus object
+        template <class BufferPtr, typename T>
+        EasySerializeStatus from_json_buffer_vector_objects(BufferPtr buffer_ptr, size_t buffer_size,
+                                                            std::vector<T> &v, RapidJsonReaderContext &context)
+        {
+            rapidjson::MemoryStream ms(buffer_ptr, buffer_size);
+            rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream> is(ms);
+            return from_json_document_vector_objects(context.parse<RAPIDJSON_PARSE_FLAGS>(is), context.archive(), v);
+        }
+
+        // Populate std::vector of primitive types with UTF-8 JSON in buffer, reusing the memory in
+        // context.
+        //
+        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
+        // \param buffer_size: size of buffer
+        // \param v: vector of primitive types to populate
+        // \param context: reader state kept between calls
+        // \return: EasySerializeStatus object
+        template <typename BufferPtr, typename T>
+        EasySerializeStatus from_json_buffer_vector(BufferPtr buffer_ptr, size_t buffer_size, std::vector<T> &v,
+                                                    RapidJsonReaderContext &context)
+        {
+            if (scan_numeric_array_document(buffer_ptr, buffer_size, v))
             {
-                RapidJsonReaderArchive a;
-                a._ez_vector_enums(_d, v, enum_value_N);
+                return EasySerializeStatus();
             }
-            catch (const std::exception &ex)
+            rapidjson::MemoryStream ms(buffer_ptr, buffer_size);
+            rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream> is(ms);
+            return from_json_document_vector(context.parse<RAPIDJSON_PARSE_FLAGS>(is), context.archive(), v);
+        }
+
+        // Populate std::vector of enums with UTF-8 JSON in buffer, reusing the memory in context.
+        //
+        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
+        // \param buffer_size: size of buffer
+        // \param v: vector of enums to populate
+        // \param enum_value_N: Last enum value (not a valid enum)
+        // \param context: reader state kept between calls
+        // \return: EasySerializeStatus object
+        template <typename BufferPtr, typename T>
+        EasySerializeStatus from_json_buffer_vector_enums(BufferPtr buffer_ptr, size_t buffer_size,
+                                                          std::vector<T> &v, T enum_value_N,
+                                                          RapidJsonReaderContext &context)
+        {
+            rapidjson::MemoryStream ms(buffer_ptr, buffer_size);
+            rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream> is(ms);
+            return from_json_document_vector_enums(context.parse<RAPIDJSON_PARSE_FLAGS>(is), context.archive(), v,
+                                                   enum_value_N);
+        }
+
+        // Populate object with UTF-8 JSON in a mutable buffer, parsing in place and reusing the
+        // memory in context.
+        //
+        // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+        // \param buffer_size: size of buffer
+        // \param obj: object to populate
+        // \param context: reader state kept between calls
+        // \return: EasySerializeStatus object
+        template <typename T>
+        EasySerializeStatus from_json_buffer_insitu(char *buffer, size_t buffer_size, T &obj,
+                                                    RapidJsonReaderContext &context)
+        {
+            InsituBufferStream is(buffer, buffer_size);
+            return from_json_document(context.parse<RAPIDJSON_PARSE_FLAGS | rapidjson::kParseInsituFlag>(is),
+                                      context.archive(), obj);
+        }
+
+        // Populate std::vector of objects with UTF-8 JSON in a mutable buffer, parsing in place and
+        // reusing the memory in context.
+        //
+        // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+        // \param buffer_size: size of buffer
+        // \param v: vector of objects to populate
+        // \param context: reader state kept between calls
+        // \return: EasySerializeStatus object
+        template <typename T>
+        EasySerializeStatus from_json_buffer_vector_objects_insitu(char *buffer, size_t buffer_size,
+                                                                   std::vector<T> &v, RapidJsonReaderContext &context)
+        {
+            InsituBufferStream is(buffer, buffer_size);
+            return from_json_document_vector_objects(
+                context.parse<RAPIDJSON_PARSE_FLAGS | rapidjson::kParseInsituFlag>(is), context.archive(), v);
+        }
+
+        // Populate std::vector of primitive types with UTF-8 JSON in a mutable buffer, parsing in
+        // place and reusing the memory in context.
+        //
+        // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+        // \param buffer_size: size of buffer
+        // \param v: vector of primitive types to populate
+        // \param context: reader state kept between calls
+        // \return: EasySerializeStatus object
+        template <typename T>
+        EasySerializeStatus from_json_buffer_vector_insitu(char *buffer, size_t buffer_size, std::vector<T> &v,
+                                                           RapidJsonReaderContext &context)
+        {
+            if (scan_numeric_array_document(buffer, buffer_size, v))
             {
-                status.set_error_message(ex.what());
+                return EasySerializeStatus();
             }
-            return status;
+            InsituBufferStream is(buffer, buffer_size);
+            return from_json_document_vector(context.parse<RAPIDJSON_PARSE_FLAGS | rapidjson::kParseInsituFlag>(is),
+                                             context.archive(), v);
+        }
+
+        // Populate std::vector of enums with UTF-8 JSON in a mutable buffer, parsing in place and
+        // reusing the memory in context.
+        //
+        // \param buffer: buffer of UTF-8 JSON (doesn't need a null terminator)
+        // \param buffer_size: size of buffer
+        // \param v: vector of enums to populate
+        // \param enum_value_N: Last enum value (not a valid enum)
+        // \param context: reader state kept between calls
+        // \return: EasySerializeStatus object
+        template <typename T>
+        EasySerializeStatus from_json_buffer_vector_enums_insitu(char *buffer, size_t buffer_size,
+                                                                 std::vector<T> &v, T enum_value_N,
+                                                                 RapidJsonReaderContext &context)
+        {
+            InsituBufferStream is(buffer, buffer_size);
+            return from_json_document_vector_enums(
+                context.parse<RAPIDJSON_PARSE_FLAGS | rapidjson::kParseInsituFlag>(is), context.archive(), v,
+                enum_value_N);
         }
     }
 }
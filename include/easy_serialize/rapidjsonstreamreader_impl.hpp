@@ -0,0 +1,1225 @@
+// easy_serialize streaming JSON reader implementation using the rapidjson SAX reader.
+#pragma once
+
+#include "easy_serialize_status.hpp"
+#include "rapidjsonnumericarray_impl.hpp"
+#include "rapidjsonreader_impl.hpp"
+
+#include <rapidjson/document.h>
+#include <rapidjson/encodedstream.h>
+#include <rapidjson/error/en.h>
+#include <rapidjson/filereadstream.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+namespace easy_serialize
+{
+    namespace rapidjson_impl
+    {
+        // Input stream over a buffer of UTF-8 JSON. Skips a byte order mark, like
+        // rapidjson::EncodedInputStream, and gives the archive direct access to the bytes for the
+        // numeric array fast path.
+        class BufferInputStream : public rapidjson::MemoryStream
+        {
+        public:
+            BufferInputStream(const Ch *src, size_t size) : rapidjson::MemoryStream(src, size)
+            {
+                if (size >= 3 && static_cast<unsigned char>(src[0]) == 0xEF &&
+                    static_cast<unsigned char>(src[1]) == 0xBB && static_cast<unsigned char>(src[2]) == 0xBF)
+                {
+                    src_ += 3;
+                }
+            }
+        };
+
+        // Input stream over a buffer of UTF-8 JSON for reading a projection: the archive skips the
+        // values of members it doesn't need straight over the bytes, matching quotes and brackets
+        // without tokenizing. The tokenizer is shown a placeholder value in their place.
+        class ProjectionInputStream : public BufferInputStream
+        {
+        public:
+            ProjectionInputStream(const Ch *src, size_t size) : BufferInputStream(src, size) {}
+
+            Ch Peek() const { return _placeholder ? *_placeholder : BufferInputStream::Peek(); }
+            Ch Take()
+            {
+                if (_placeholder)
+                {
+                    const Ch c = *_placeholder++;
+                    if (!*_placeholder)
+                    {
+                        _placeholder = nullptr;
+                    }
+                    return c;
+                }
+                return BufferInputStream::Take();
+            }
+
+            // Skip the ':' and value of the member whose key the tokenizer just read, leaving a
+            // placeholder value. Skipped values aren't validated. If there's no ':', the stream is
+            // left for the tokenizer to report the error.
+            //
+            // \return: start of the skipped value (which ends at src_), or nullptr if there's no ':'
+            const Ch *skipMemberValue()
+            {
+                const Ch *p = skipWhitespace(src_);
+                if (p == end_ || *p != ':')
+                {
+                    return nullptr;
+                }
+                p = skipWhitespace(p + 1);
+                const Ch *value = p;
+                if (p != end_ && (*p == '{' || *p == '['))
+                {
+                    p = skipContainer(p);
+                }
+                else if (p != end_ && *p == '"')
+                {
+                    p = skipString(p);
+                }
+                else
+                {
+                    while (p != end_ && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\n' &&
+                           *p != '\r' && *p != '\t')
+                    {
+                        ++p;
+                    }
+                }
+                src_ = p;
+                _placeholder = ":0";
+                return value;
+            }
+
+        private:
+            const Ch *skipWhitespace(const Ch *p) const
+            {
+                while (p != end_ && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+                {
+                    ++p;
+                }
+                return p;
+            }
+            // Skip the string starting at p (a '"'), to just after its closing quote.
+            const Ch *skipString(const Ch *p) const
+            {
+                for (++p; p != end_; ++p)
+                {
+                    if (*p == '"')
+                    {
+                        return p + 1;
+                    }
+                    if (*p == '\\' && ++p == end_)
+                    {
+                        break;
+                    }
+                }
+                return end_;
+            }
+            // Skip the object or array starting at p, to just after its closing bracket.
+            const Ch *skipContainer(const Ch *p) const
+            {
+                int depth = 0;
+                while (p != end_)
+                {
+                    switch (*p)
+                    {
+                    case '"':
+                        p = skipString(p);
+                        continue;
+                    case '{':
+                    case '[':
+                        ++depth;
+                        break;
+                    case '}':
+                    case ']':
+                        if (--depth == 0)
+                        {
+                            return p + 1;
+                        }
+                        break;
+                    default:
+                        break;
+                    }
+                    ++p;
+                }
+                return end_;
+            }
+
+            const Ch *_placeholder = nullptr;
+        };
+
+        // Archive that runs a type's serialize() only to record the keys it reads.
+        class SerializeKeysArchive
+        {
+        public:
+            explicit SerializeKeysArchive(std::unordered_set<std::string> &keys) : _keys(keys) {}
+            void class_version(const int /*class_version_*/) { _keys.insert("_objver"); }
+            template <typename T>
+            void ez(JsonKey key, T & /*t*/, int /*object_version_supported*/ = 0)
+            {
+                insert(key);
+            }
+            template <typename T>
+            void ez_enum(JsonKey key, T & /*e*/, T /*enum_value_N*/, int /*object_version_supported*/ = 0)
+            {
+                insert(key);
+            }
+            template <typename T>
+            void ez_object(JsonKey key, T & /*o*/, int /*object_version_supported*/ = 0)
+            {
+                insert(key);
+            }
+            template <typename T>
+            void ez_vector(JsonKey key, std::vector<T> & /*v*/, int /*object_version_supported*/ = 0)
+            {
+                insert(key);
+            }
+            template <typename T>
+            void ez_vector_enums(JsonKey key, std::vector<T> & /*v*/, T /*enum_value_N*/,
+                                 int /*object_version_supported*/ = 0)
+            {
+                insert(key);
+            }
+            template <typename T>
+            void ez_vector_objects(JsonKey key, std::vector<T> & /*v*/, int /*object_version_supported*/ = 0)
+            {
+                insert(key);
+            }
+
+        private:
+            void insert(const JsonKey &key) { _keys.insert(std::string(key.name, key.length)); }
+
+            std::unordered_set<std::string> &_keys;
+        };
+
+        // Get the keys type T's serialize() reads, finding them on the first call.
+        //
+        // \return: keys, shared by all calls for type T
+        template <typename T>
+        const std::unordered_set<std::string> &get_serialize_keys()
+        {
+            static const std::unordered_set<std::string> keys = []()
+            {
+                std::unordered_set<std::string> k;
+                SerializeKeysArchive a(k);
+                T t;
+                t.serialize(a);
+                return k;
+            }();
+            return keys;
+        }
+
+        // rapidjson SAX handler that holds the most recent token.
+        struct StreamToken : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, StreamToken>
+        {
+            enum class Type
+            {
+                value,
+                key,
+                start_object,
+                end_object,
+                start_array,
+                end_array,
+                // Not a token. The tokenizer failed.
+                error,
+            };
+
+            bool Null()
+            {
+                type = Type::value;
+                value.SetNull();
+                return true;
+            }
+            bool Bool(bool b)
+            {
+                type = Type::value;
+                value.SetBool(b);
+                return true;
+            }
+            bool Int(int i)
+            {
+                type = Type::value;
+                value.SetInt(i);
+                return true;
+            }
+            bool Uint(unsigned u)
+            {
+                type = Type::value;
+                value.SetUint(u);
+                return true;
+            }
+            bool Int64(int64_t i64)
+            {
+                type = Type::value;
+                value.SetInt64(i64);
+                return true;
+            }
+            bool Uint64(uint64_t u64)
+            {
+                type = Type::value;
+                value.SetUint64(u64);
+                return true;
+            }
+            bool Double(double d)
+            {
+                type = Type::value;
+                value.SetDouble(d);
+                return true;
+            }
+            bool String(const char *str, rapidjson::SizeType length, bool /*copy*/)
+            {
+                type = Type::value;
+                string.assign(str, length);
+                value.SetString(rapidjson::StringRef(string.data(), length));
+                return true;
+            }
+            bool Key(const char *str, rapidjson::SizeType length, bool /*copy*/)
+            {
+                type = Type::key;
+                string.assign(str, length);
+                return true;
+            }
+            bool StartObject()
+            {
+                type = Type::start_object;
+                value.SetObject();
+                return true;
+            }
+            bool EndObject(rapidjson::SizeType /*member_count*/)
+            {
+                type = Type::end_object;
+                return true;
+            }
+            bool StartArray()
+            {
+                type = Type::start_array;
+                value.SetArray();
+                return true;
+            }
+            bool EndArray(rapidjson::SizeType /*element_count*/)
+            {
+                type = Type::end_array;
+                return true;
+            }
+
+            Type type = Type::value;
+            rapidjson::Value value;
+            std::string string;
+        };
+
+        // JSON reader archive that binds values as rapidjson tokenizes them, without building a
+        // rapidjson::Document.
+        //
+        // Members are expected in serialize() order, which is how RapidJsonWriterArchive writes
+        // them. A member that shows up before it is asked for is buffered until serialize() gets
+        // to it, so other orderings still read correctly at the cost of holding those members in
+        // memory until the outermost object holding any of them ends. "_objver" is only looked
+        // for ahead of the members serialize() has asked for.
+        //
+        // Errors are recorded in the same way as RapidJsonReaderArchive, whose status this
+        // archive shares. Malformed JSON stops the reading and finish() reports the parse error.
+        //
+        // With a ProjectionInputStream, members that serialize() doesn't read on a default object
+        // are skipped over the bytes instead of being tokenized (and buffered, if they come before
+        // the members asked for), so reading a few members of a large object only pays for those
+        // members. Where the skipped bytes were is kept until the object ends, in case
+        // serialize() asks for the member after all.
+        template <typename InputStream>
+        class RapidJsonStreamReaderArchive
+        {
+        public:
+            explicit RapidJsonStreamReaderArchive(InputStream &is_) : _is(is_)
+            {
+                _reader.IterativeParseInit();
+                // The iterative parser reports an empty document as an invalid value, so check here.
+                rapidjson::SkipWhitespace(_is);
+                _empty = _is.Peek() == '\0';
+            }
+            // Bytes held for members read ahead of the ones serialize() asked for.
+            size_t capacity() const { return _allocator.Capacity(); }
+            void class_version(const int class_version_)
+            {
+                if (!_dom._status)
+                {
+                    return;
+                }
+                Frame &frame = _stack.back();
+                bool ok = false;
+                const rapidjson::Value *pending = nullptr;
+                if (!findPending("_objver", 7, pending))
+                {
+                    _dom._status.add_error_key("_objver");
+                    return;
+                }
+                if (pending)
+                {
+                    ok = _dom._ez(*pending, frame.objver);
+                }
+                else if (!frame.ended && peek().type == StreamToken::Type::key && _token.string == "_objver")
+                {
+                    take();
+                    ok = _ez(frame.objver);
+                }
+                else
+                {
+                    // leave objver at zero default.
+                    return;
+                }
+                if (!ok)
+                {
+                    _dom._status.add_error_key("_objver");
+                }
+                else if (class_version_ < frame.objver)
+                {
+                    _dom.fail(" object too new");
+                    _dom._status.add_error_key("_objver");
+                }
+            }
+            template <typename T>
+            void ez(JsonKey key, T &t)
+            {
+                if (!_dom._status)
+                {
+                    return;
+                }
+                const rapidjson::Value *pending = nullptr;
+                if (!seekKey(key, pending) || !(pending ? _dom._ez(*pending, t) : _ez(t)))
+                {
+                    _dom._status.add_error_key(key.name);
+                }
+            }
+            template <typename T>
+            void ez(JsonKey key, T &t, int object_version_supported)
+            {
+                if (object_version_supported > _stack.back().objver)
+                {
+                    return;
+                }
+                ez(key, t);
+            }
+            template <typename T>
+            void ez_enum(JsonKey key, T &e, T enum_value_N)
+            {
+                if (!_dom._status)
+                {
+                    return;
+                }
+                const rapidjson::Value *pending = nullptr;
+                if (!seekKey(key, pending) ||
+                    !(pending ? _dom._ez_enum(*pending, e, enum_value_N) : _ez_enum(e, enum_value_N)))
+                {
+                    _dom._status.add_error_key(key.name);
+                }
+            }
+            template <typename T>
+            void ez_enum(JsonKey key, T &e, T enum_value_N, int object_version_supported)
+            {
+                if (object_version_supported > _stack.back().objver)
+                {
+                    return;
+                }
+                ez_enum(key, e, enum_value_N);
+            }
+            template <typename T>
+            void ez_object(JsonKey key, T &o)
+            {
+                if (!_dom._status)
+                {
+                    return;
+                }
+                const rapidjson::Value *pending = nullptr;
+                if (!seekKey(key, pending) || !(pending ? _dom._ez_object(*pending, o) : _ez_object(o)))
+                {
+                    _dom._status.add_error_key(key.name);
+                }
+            }
+            template <typename T>
+            void ez_object(JsonKey key, T &o, int object_version_supported)
+            {
+                if (object_version_supported > _stack.back().objver)
+                {
+                    return;
+                }
+                ez_object(key, o);
+            }
+            template <typename T>
+            void ez_vector(JsonKey key, std::vector<T> &v)
+            {
+                if (!_dom._status)
+                {
+                    return;
+                }
+                const rapidjson::Value *pending = nullptr;
+                if (!seekKey(key, pending) || !(pending ? _dom._ez_vector(*pending, v) : _ez_vector(v)))
+                {
+                    _dom._status.add_error_key(key.name);
+                }
+            }
+            template <typename T>
+            void ez_vector(JsonKey key, std::vector<T> &v, int object_version_supported)
+            {
+                if (object_version_supported > _stack.back().objver)
+                {
+                    return;
+                }
+                ez_vector(key, v);
+            }
+            template <typename T>
+            void ez_vector_enums(JsonKey key, std::vector<T> &v, T enum_value_N)
+            {
+                if (!_dom._status)
+                {
+                    return;
+                }
+                const rapidjson::Value *pending = nullptr;
+                if (!seekKey(key, pending) || !(pending ? _dom._ez_vector_enums(*pending, v, enum_value_N)
+                                                        : _ez_vector_enums(v, enum_value_N)))
+                {
+                    _dom._status.add_error_key(key.name);
+                }
+            }
+            template <typename T>
+            void ez_vector_enums(JsonKey key, std::vector<T> &v, T enum_value_N, int object_version_supported)
+            {
+                if (object_version_supported > _stack.back().objver)
+                {
+                    return;
+                }
+                ez_vector_enums(key, v, enum_value_N);
+            }
+            template <typename T>
+            void ez_vector_objects(JsonKey key, std::vector<T> &v)
+            {
+                if (!_dom._status)
+                {
+                    return;
+                }
+                const rapidjson::Value *pending = nullptr;
+                if (!seekKey(key, pending) || !(pending ? _dom._ez_vector_objects(*pending, v) : _ez_vector_objects(v)))
+                {
+                    _dom._status.add_error_key(key.name);
+                }
+            }
+            template <typename T>
+            void ez_vector_objects(JsonKey key, std::vector<T> &v, int object_version_supported)
+            {
+                if (object_version_supported > _stack.back().objver)
+                {
+                    return;
+                }
+                ez_vector_objects(key, v);
+            }
+            RapidJsonStreamReaderArchive(const RapidJsonStreamReaderArchive &) = delete;
+            RapidJsonStreamReaderArchive &operator=(const RapidJsonStreamReaderArchive &) = delete;
+
+            template <typename Stream, typename T>
+            friend EasySerializeStatus from_json_stream(Stream &is, T &obj);
+            template <typename Stream, typename T>
+            friend EasySerializeStatus from_json_stream_vector_objects(Stream &is, std::vector<T> &v);
+            template <typename Stream, typename T>
+            friend EasySerializeStatus from_json_stream_vector(Stream &is, std::vector<T> &v);
+            template <typename Stream, typename T>
+            friend EasySerializeStatus from_json_stream_vector_enums(Stream &is, std::vector<T> &v, T enum_value_N);
+            template <typename T, typename Stream, typename Callback>
+            friend EasySerializeStatus for_each_json_stream_object(Stream &is, Callback &callback);
+
+        private:
+            template <typename T>
+            bool _ez(T &t)
+            {
+                const StreamToken &token = next();
+                return token.type != StreamToken::Type::error && _dom._ez(token.value, t);
+            }
+            template <typename T>
+            bool _ez(Lazy<T> &lazy)
+            {
+                return readLazy(_is, lazy);
+            }
+            template <typename T>
+            bool _ez_enum(T &e, T enum_value_N)
+            {
+                const StreamToken &token = next();
+                return token.type != StreamToken::Type::error && _dom._ez_enum(token.value, e, enum_value_N);
+            }
+            template <typename T>
+            bool _ez_object(T &obj)
+            {
+                if (next().type != StreamToken::Type::start_object)
+                {
+                    return _dom.fail(" expected an object");
+                }
+                _stack.emplace_back();
+                _stack.back().keys = projectionKeys<T>(_is);
+                _stack.back().skipped_begin = _skipped.size();
+                obj.serialize(*this);
+                // Skip the members serialize() didn't ask for.
+                while (_dom._status && !_stack.back().ended)
+                {
+                    if (next().type == StreamToken::Type::end_object)
+                    {
+                        _stack.back().ended = true;
+                    }
+                    else
+                    {
+                        skipMemberValue(_is, false);
+                    }
+                }
+                if (!_stack.back().pending.ObjectEmpty())
+                {
+                    --_pending_frames;
+                }
+                _skipped.resize(_stack.back().skipped_begin);
+                _stack.pop_back();
+                releasePool();
+                return static_cast<bool>(_dom._status);
+            }
+            template <typename T>
+            bool _ez_vector(std::vector<T> &v)
+            {
+                if (next().type != StreamToken::Type::start_array)
+                {
+                    return _dom.fail(" expected an array");
+                }
+                v.clear();
+                scanNumbers(_is, v, IsScannableNumber<T>());
+                for (auto i = static_cast<rapidjson::SizeType>(v.size()); hasMore(StreamToken::Type::end_array); ++i)
+                {
+                    T t;
+                    if (!_ez(t))
+                    {
+                        _dom._status.add_error_index(i);
+                        return false;
+                    }
+                    v.push_back(t);
+                }
+                take();
+                return static_cast<bool>(_dom._status);
+            }
+            template <typename T>
+            bool _ez_vector_objects(std::vector<T> &v)
+            {
+                if (next().type != StreamToken::Type::start_array)
+                {
+                    return _dom.fail(" expected an array");
+                }
+                v.clear();
+                for (rapidjson::SizeType i = 0; hasMore(StreamToken::Type::end_array); ++i)
+                {
+                    T object;
+                    if (!_ez_object(object))
+                    {
+                        _dom._status.add_error_index(i);
+                        return false;
+                    }
+                    v.push_back(std::move(object));
+                }
+                take();
+                return static_cast<bool>(_dom._status);
+            }
+            // Read an array of objects one element at a time, handing each to
+            // callback(size_t index, T &obj) until it returns false, which sets stopped.
+            template <typename T, typename Callback>
+            bool _for_each_object(Callback &callback, bool &stopped)
+            {
+                if (next().type != StreamToken::Type::start_array)
+                {
+                    return _dom.fail(" expected an array");
+                }
+                for (size_t i = 0; hasMore(StreamToken::Type::end_array); ++i)
+                {
+                    T object;
+                    if (!_ez_object(object))
+                    {
+                        _dom._status.add_error_index(i);
+                        return false;
+                    }
+                    if (!callback(i, object))
+                    {
+                        stopped = true;
+                        return true;
+                    }
+                }
+                take();
+                return static_cast<bool>(_dom._status);
+            }
+            template <typename T>
+            bool _ez_vector_enums(std::vector<T> &v, T enum_value_N)
+            {
+                if (next().type != StreamToken::Type::start_array)
+                {
+                    return _dom.fail(" expected an array");
+                }
+                v.clear();
+                const EnumNames<T> &names = get_enum_names(enum_value_N);
+                for (rapidjson::SizeType i = 0; hasMore(StreamToken::Type::end_array); ++i)
+                {
+                    const StreamToken &token = next();
+                    T t;
+                    if (token.type == StreamToken::Type::error || !_dom._ez_enum(token.value, t, names))
+                    {
+                        _dom._status.add_error_index(i);
+                        return false;
+                    }
+                    v.push_back(t);
+                }
+                take();
+                return static_cast<bool>(_dom._status);
+            }
+            // Read the elements of a numeric array in memory straight from the bytes, just after the
+            // array's start token. Stops at the array's end or at an element the scanner leaves to
+            // rapidjson, and the tokenizer carries on from there.
+            template <typename T>
+            static void scanNumbers(BufferInputStream &is, std::vector<T> &v, std::true_type /*scannable*/)
+            {
+                is.src_ = NumericArrayScanner::scan(is.src_, is.end_, v);
+            }
+            template <typename T>
+            static void scanNumbers(ProjectionInputStream &is, std::vector<T> &v, std::true_type scannable)
+            {
+                scanNumbers(static_cast<BufferInputStream &>(is), v, scannable);
+            }
+            template <typename Stream, typename T, typename Scannable>
+            static void scanNumbers(Stream & /*is*/, std::vector<T> & /*v*/, Scannable)
+            {
+            }
+            // Keys of T that serialize() reads on a default object, when reading a projection.
+            template <typename T>
+            static const std::unordered_set<std::string> *projectionKeys(ProjectionInputStream & /*is*/)
+            {
+                return &get_serialize_keys<T>();
+            }
+            template <typename T, typename Stream>
+            static const std::unordered_set<std::string> *projectionKeys(Stream & /*is*/)
+            {
+                return nullptr;
+            }
+            // Skip the value of the member whose key was just read. If keep, remember where the
+            // value is, so findPending() can still read it.
+            void skipMemberValue(ProjectionInputStream &is, bool keep)
+            {
+                const char *value = is.skipMemberValue();
+                if (keep && value)
+                {
+                    _skipped.push_back({_token.string, value, static_cast<size_t>(is.src_ - value)});
+                }
+                next();
+            }
+            template <typename Stream>
+            void skipMemberValue(Stream & /*is*/, bool /*keep*/)
+            {
+                skipValue();
+            }
+            // Copy the bytes of the value of the member whose key was just read.
+            template <typename T>
+            bool readLazy(ProjectionInputStream &is, Lazy<T> &lazy)
+            {
+                const char *value = is.skipMemberValue();
+                const char *value_end = is.src_;
+                // Reads the placeholder, or reports the missing ':'.
+                if (next().type == StreamToken::Type::error)
+                {
+                    return false;
+                }
+                if (value == value_end || *value != (Lazy<T>::is_array ? '[' : '{'))
+                {
+                    return _dom.fail(Lazy<T>::is_array ? " expected an array" : " expected an object");
+                }
+                lazy.set_raw(value, static_cast<size_t>(value_end - value));
+                return true;
+            }
+            // Tokenize the value of the member whose key was just read, then copy its bytes.
+            template <typename T>
+            bool readLazy(BufferInputStream &is, Lazy<T> &lazy)
+            {
+                const StreamToken::Type start = peek().type;
+                if (start == StreamToken::Type::error)
+                {
+                    return false;
+                }
+                if (start != (Lazy<T>::is_array ? StreamToken::Type::start_array : StreamToken::Type::start_object))
+                {
+                    return _dom.fail(Lazy<T>::is_array ? " expected an array" : " expected an object");
+                }
+                // The tokenizer stops just after the bracket of a start or end token.
+                const char *value = is.src_ - 1;
+                skipValue();
+                if (!_dom._status)
+                {
+                    return false;
+                }
+                lazy.set_raw(value, static_cast<size_t>(is.src_ - value));
+                return true;
+            }
+            // Any other stream can't be read back, so the value is built and written out again.
+            template <typename Stream, typename T>
+            bool readLazy(Stream & /*is*/, Lazy<T> &lazy)
+            {
+                rapidjson::Value value;
+                readValue(value);
+                return _dom._status && _dom._ez(value, lazy);
+            }
+            // Find key among the members of the current object read ahead, or skipped when reading
+            // a projection. A skipped member's value is parsed into the read ahead members now,
+            // recording the parse error (and returning false) if it's malformed.
+            //
+            // \param pending: set to the member's value, or nullptr if it isn't there
+            // \return: false on a parse error
+            bool findPending(const char *key, size_t length, const rapidjson::Value *&pending)
+            {
+                Frame &frame = _stack.back();
+                const auto it = frame.pending.FindMember(
+                    rapidjson::Value(rapidjson::StringRef(key, static_cast<rapidjson::SizeType>(length))));
+                if (it != frame.pending.MemberEnd())
+                {
+                    pending = &it->value;
+                    return true;
+                }
+                pending = nullptr;
+                for (size_t i = frame.skipped_begin; i < _skipped.size(); ++i)
+                {
+                    const SkippedMember &skipped = _skipped[i];
+                    if (skipped.key.size() != length || std::memcmp(skipped.key.data(), key, length) != 0)
+                    {
+                        continue;
+                    }
+                    rapidjson::GenericDocument<rapidjson::UTF8<>, rapidjson::MemoryPoolAllocator<>> value(
+                        &_allocator);
+                    value.Parse<RAPIDJSON_PARSE_FLAGS>(skipped.value, skipped.size);
+                    if (value.HasParseError())
+                    {
+                        _dom._status.set_error_message(rapidjson::GetParseError_En(value.GetParseError()));
+                        return false;
+                    }
+                    rapidjson::Value name(key, static_cast<rapidjson::SizeType>(length), _allocator);
+                    if (frame.pending.ObjectEmpty())
+                    {
+                        ++_pending_frames;
+                    }
+                    frame.pending.AddMember(name, static_cast<rapidjson::Value &>(value), _allocator);
+                    pending = &(frame.pending.MemberEnd() - 1)->value;
+                    return true;
+                }
+                return true;
+            }
+            // Find key in the current object, or record an error and return false. Sets pending to
+            // the buffered value if the member was read ahead earlier, or nullptr when the stream
+            // is positioned at the member's value.
+            bool seekKey(const JsonKey &key, const rapidjson::Value *&pending)
+            {
+                Frame &frame = _stack.back();
+                if (!findPending(key.name, key.length, pending))
+                {
+                    return false;
+                }
+                if (pending)
+                {
+                    return true;
+                }
+                while (!frame.ended)
+                {
+                    const StreamToken::Type type = next().type;
+                    if (type == StreamToken::Type::error)
+                    {
+                        return false;
+                    }
+                    if (type == StreamToken::Type::end_object)
+                    {
+                        frame.ended = true;
+                        break;
+                    }
+                    if (_token.string.size() == key.length &&
+                        std::memcmp(_token.string.data(), key.name, key.length) == 0)
+                    {
+                        return true;
+                    }
+                    if (frame.keys && !frame.keys->count(_token.string))
+                    {
+                        // serialize() doesn't ask for this member on a default object, but may on
+                        // this one, so its place is kept.
+                        skipMemberValue(_is, true);
+                        continue;
+                    }
+                    rapidjson::Value name(_token.string.data(),
+                                          static_cast<rapidjson::SizeType>(_token.string.size()),
+                                          _allocator);
+                    rapidjson::Value value;
+                    readValue(value);
+                    if (frame.pending.ObjectEmpty())
+                    {
+                        ++_pending_frames;
+                    }
+                    frame.pending.AddMember(name, value, _allocator);
+                }
+                return _dom.fail(" key not found");
+            }
+            // Free the values read ahead into the pool once no frame holds any, so memory stays
+            // bounded by the largest object rather than growing with the stream. The pool is
+            // only cleared once it has grown past its first chunk, since clearing it frees
+            // every chunk.
+            void releasePool()
+            {
+                if (_pending_frames == 0 && _allocator.Capacity() > pool_chunk_capacity)
+                {
+                    _allocator.Clear();
+                }
+            }
+            // Build the next value in the stream into a DOM value.
+            void readValue(rapidjson::Value &value)
+            {
+                switch (next().type)
+                {
+                case StreamToken::Type::start_object:
+                    value.SetObject();
+                    while (hasMore(StreamToken::Type::end_object))
+                    {
+                        take();
+                        rapidjson::Value name(_token.string.data(),
+                                              static_cast<rapidjson::SizeType>(_token.string.size()),
+                                              _allocator);
+                        rapidjson::Value member;
+                        readValue(member);
+                        value.AddMember(name, member, _allocator);
+                    }
+                    take();
+                    break;
+                case StreamToken::Type::start_array:
+                    value.SetArray();
+                    while (hasMore(StreamToken::Type::end_array))
+                    {
+                        rapidjson::Value element;
+                        readValue(element);
+                        value.PushBack(element, _allocator);
+                    }
+                    take();
+                    break;
+                case StreamToken::Type::error:
+                    break;
+                default:
+                    if (_token.value.IsString())
+                    {
+                        value.SetString(_token.string.data(),
+                                        static_cast<rapidjson::SizeType>(_token.string.size()),
+                                        _allocator);
+                    }
+                    else
+                    {
+                        value = _token.value;
+                    }
+                    break;
+                }
+            }
+            void skipValue()
+            {
+                int depth = 0;
+                do
+                {
+                    switch (next().type)
+                    {
+                    case StreamToken::Type::start_object:
+                    case StreamToken::Type::start_array:
+                        ++depth;
+                        break;
+                    case StreamToken::Type::end_object:
+                    case StreamToken::Type::end_array:
+                        --depth;
+                        break;
+                    case StreamToken::Type::error:
+                        return;
+                    default:
+                        break;
+                    }
+                } while (depth > 0);
+            }
+            // The next token, without consuming it. On malformed JSON, records an error (finish()
+            // replaces it with the parse error) and returns an error token.
+            const StreamToken &peek()
+            {
+                if (!_has_token)
+                {
+                    if (_empty || _reader.IterativeParseComplete() ||
+                        !_reader.IterativeParseNext<RAPIDJSON_PARSE_FLAGS>(_is, _token))
+                    {
+                        _dom.fail(" invalid JSON");
+                        _token.type = StreamToken::Type::error;
+                        return _token;
+                    }
+                    _has_token = true;
+                }
+                return _token;
+            }
+            // True until the end token of the current object or array, or an error.
+            bool hasMore(StreamToken::Type end)
+            {
+                return peek().type != end && _dom._status;
+            }
+            void take()
+            {
+                _has_token = false;
+            }
+            const StreamToken &next()
+            {
+                peek();
+                take();
+                return _token;
+            }
+            // Tokenize the rest of the document so a syntax error anywhere in it is reported in
+            // place of a binding error, the same as with RapidJsonReaderArchive.
+            //
+            // \return: EasySerializeStatus object
+            EasySerializeStatus finish()
+            {
+                if (_empty)
+                {
+                    _dom._status.set_error_message(
+                        rapidjson::GetParseError_En(rapidjson::kParseErrorDocumentEmpty));
+                    return _dom._status;
+                }
+                while (!_reader.IterativeParseComplete())
+                {
+                    _reader.IterativeParseNext<RAPIDJSON_PARSE_FLAGS>(_is, _token);
+                }
+                if (_reader.HasParseError())
+                {
+                    _dom._status.set_error_message(rapidjson::GetParseError_En(_reader.GetParseErrorCode()));
+                }
+                return _dom._status;
+            }
+            struct Frame
+            {
+                rapidjson::Value pending{rapidjson::kObjectType};
+                int objver = 0;
+                bool ended = false;
+                // Keys serialize() reads on a default object when reading a projection, otherwise
+                // nullptr.
+                const std::unordered_set<std::string> *keys = nullptr;
+                // This object's members in _skipped start here.
+                size_t skipped_begin = 0;
+            };
+            // Member skipped over when reading a projection, with its value's bytes.
+            struct SkippedMember
+            {
+                std::string key;
+                const char *value;
+                size_t size;
+            };
+            InputStream &_is;
+            rapidjson::Reader _reader;
+            StreamToken _token;
+            bool _has_token = false;
+            bool _empty = false;
+            static const size_t pool_chunk_capacity = 64 * 1024;
+            rapidjson::MemoryPoolAllocator<> _allocator{pool_chunk_capacity};
+            // Frames on the stack with members in pending.
+            size_t _pending_frames = 0;
+            std::vector<Frame> _stack;
+            // Members skipped by the objects on the stack, in stack order.
+            std::vector<SkippedMember> _skipped;
+            RapidJsonReaderArchive _dom;
+        };
+
+        // Populate object from a UTF-8 JSON input stream, binding values as they are parsed.
+        //
+        // \param is: rapidjson input stream
+        // \param obj: object to populate
+        // \return: EasySerializeStatus object
+        template <typename Stream, typename T>
+        EasySerializeStatus from_json_stream(Stream &is, T &obj)
+        {
+            RapidJsonStreamReaderArchive<Stream> a(is);
+            a._ez_object(obj);
+            return a.finish();
+        }
+
+        // Populate std::vector of objects from a UTF-8 JSON input stream, binding values as they
+        // are parsed.
+        //
+        // \param is: rapidjson input stream
+        // \param v: vector of objects to populate
+        // \return: EasySerializeStatus object
+        template <typename Stream, typename T>
+        EasySerializeStatus from_json_stream_vector_objects(Stream &is, std::vector<T> &v)
+        {
+            RapidJsonStreamReaderArchive<Stream> a(is);
+            a._ez_vector_objects(v);
+            return a.finish();
+        }
+
+        // Populate std::vector of primitive types from a UTF-8 JSON input stream, binding values
+        // as they are parsed.
+        //
+        // \param is: rapidjson input stream
+        // \param v: vector of primitive types to populate
+        // \return: EasySerializeStatus object
+        template <typename Stream, typename T>
+        EasySerializeStatus from_json_stream_vector(Stream &is, std::vector<T> &v)
+        {
+            RapidJsonStreamReaderArchive<Stream> a(is);
+            a._ez_vector(v);
+            return a.finish();
+        }
+
+        // Populate std::vector of enums from a UTF-8 JSON input stream, binding values as they
+        // are parsed.
+        //
+        // \param is: rapidjson input stream
+        // \param v: vector of enums to populate
+        // \param enum_value_N: Last enum value (not a valid enum)
+        // \return: EasySerializeStatus object
+        template <typename Stream, typename T>
+        EasySerializeStatus from_json_stream_vector_enums(Stream &is, std::vector<T> &v, T enum_value_N)
+        {
+            RapidJsonStreamReaderArchive<Stream> a(is);
+            a._ez_vector_enums(v, enum_value_N);
+            return a.finish();
+        }
+
+        // Read an array of objects from a UTF-8 JSON input stream one element at a time, calling
+        // bool callback(size_t index, T &obj) for each. Only one element is in memory at a time.
+        // If the callback returns false, reading stops there (without checking the rest of the
+        // JSON).
+        //
+        // \param is: rapidjson input stream
+        // \param callback: called for each element
+        // \return: EasySerializeStatus object
+        template <typename T, typename Stream, typename Callback>
+        EasySerializeStatus for_each_json_stream_object(Stream &is, Callback &callback)
+        {
+            RapidJsonStreamReaderArchive<Stream> a(is);
+            bool stopped = false;
+            a.template _for_each_object<T>(callback, stopped);
+            return stopped ? EasySerializeStatus() : a.finish();
+        }
+
+        // Open a file and read it with read(Stream &is), through a fixed-size buffer, so memory use
+        // doesn't depend on the size of the file.
+        //
+        // \param filename: name of file
+        // \param read: function reading the stream, returning an EasySerializeStatus
+        // \param buffer_size: bytes to read from the file at a time
+        // \return: status from read, or a file error
+        template <typename Read>
+        EasySerializeStatus read_json_file_stream(const std::string &filename, Read read,
+                                                  size_t buffer_size = 64 * 1024)
+        {
+            EasySerializeStatus status;
+            std::FILE *fp = std::fopen(filename.c_str(), "rb");
+            if (!fp)
+            {
+                status.set_error_message("File opening failed.");
+                return status;
+            }
+            std::vector<char> buffer(buffer_size);
+            rapidjson::FileReadStream file_stream(fp, buffer.data(), buffer.size());
+            // Skips a UTF-8 BOM.
+            rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::FileReadStream> is(file_stream);
+            status = read(is);
+            if (std::ferror(fp))
+            {
+                status.set_error_message("File reading error.");
+            }
+            std::fclose(fp);
+            return status;
+        }
+
+        // Populate object with UTF-8 JSON in a buffer, binding values as they are parsed.
+        //
+        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
+        // \param buffer_size: size of buffer
+        // \param obj: object to populate
+        // \return: EasySerializeStatus object
+        template <typename BufferPtr, typename T>
+        EasySerializeStatus from_json_buffer_streaming(BufferPtr buffer_ptr, size_t buffer_size, T &obj)
+        {
+            BufferInputStream is(buffer_ptr, buffer_size);
+            return from_json_stream(is, obj);
+        }
+
+        // Populate std::vector of objects with UTF-8 JSON in buffer, binding values as they are parsed.
+        //
+        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
+        // \param buffer_size: size of buffer
+        // \param v: vector of objects to populate
+        // \return: EasySerializeStatus object
+        template <class BufferPtr, typename T>
+        EasySerializeStatus from_json_buffer_vector_objects_streaming(BufferPtr buffer_ptr,
+                                                                      size_t buffer_size,
+                                                                      std::vector<T> &v)
+        {
+            BufferInputStream is(buffer_ptr, buffer_size);
+            return from_json_stream_vector_objects(is, v);
+        }
+
+        // Populate object with UTF-8 JSON in a buffer, reading only the members its serialize()
+        // asks for. Other members are skipped without being parsed or validated.
+        //
+        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
+        // \param buffer_size: size of buffer
+        // \param obj: object to populate
+        // \return: EasySerializeStatus object
+        template <typename BufferPtr, typename T>
+        EasySerializeStatus from_json_buffer_projection(BufferPtr buffer_ptr, size_t buffer_size, T &obj)
+        {
+            ProjectionInputStream is(buffer_ptr, buffer_size);
+            return from_json_stream(is, obj);
+        }
+
+        // Populate std::vector of objects with UTF-8 JSON in buffer, reading only the members the
+        // objects' serialize() asks for. Other members are skipped without being parsed or
+        // validated.
+        //
+        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
+        // \param buffer_size: size of buffer
+        // \param v: vector of objects to populate
+        // \return: EasySerializeStatus object
+        template <class BufferPtr, typename T>
+        EasySerializeStatus from_json_buffer_vector_objects_projection(BufferPtr buffer_ptr, size_t buffer_size,
+                                                                       std::vector<T> &v)
+        {
+            ProjectionInputStream is(buffer_ptr, buffer_size);
+            return from_json_stream_vector_objects(is, v);
+        }
+
+        // Populate std::vector of primitive types with UTF-8 JSON in buffer, binding values as they
+        // are parsed.
+        //
+        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
+        // \param buffer_size: size of buffer
+        // \param v: vector of primitive types to populate
+        // \return: EasySerializeStatus object
+        template <typename BufferPtr, typename T>
+        EasySerializeStatus from_json_buffer_vector_streaming(BufferPtr buffer_ptr, size_t buffer_size,
+                                                              std::vector<T> &v)
+        {
+            BufferInputStream is(buffer_ptr, buffer_size);
+            return from_json_stream_vector(is, v);
+        }
+
+        // Populate std::vector of enums with UTF-8 JSON in buffer, binding values as they are parsed.
+        //
+        // Constraints:
+        //  * The client must define a char* to_string(Enum) function. The returned strings
+        //    must be unique.
+        //  * The enum integer values must be contiguous from  0 to < enum_value_N.
+        //
+        // \param buffer_ptr: pointer to buffer of UTF-8 JSON (gets reinterpret_cast to char*)
+        // \param buffer_size: size of buffer
+        // \param v: vector of enums to populate
+        // \param enum_value_N: Last enum value (not a valid enum)
+        // \return: EasySerializeStatus object
+        template <typename BufferPtr, typename T>
+        EasySerializeStatus from_json_buffer_vector_enums_streaming(BufferPtr buffer_ptr, size_t buffer_size,
+                                                                    std::vector<T> &v, T enum_value_N)
+        {
+            BufferInputStream is(buffer_ptr, buffer_size);
+            return from_json_stream_vector_enums(is, v, enum_value_N);
+        }
+    }
+}
@@ -1,12 +1,18 @@
 // easy_serialize JSON writer implementation using rapidjson.
 #pragma once
 
+#include "easy_serialize_config.hpp"
 #include "easy_serialize_status.hpp"
+#include "enum_names.hpp"
 #include "json_indent.hpp"
+#include "json_key.hpp"
+#include "json_number.hpp"
 
 #include <rapidjson/prettywriter.h>
-#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <stdexcept>
 #include <string>
@@ -14,135 +20,222 @@
 
 namespace easy_serialize
 {
+    template <typename T>
+    class Lazy;
+
     namespace rapidjson_impl
     {
+        // Copy a key that needs no escaping (see JsonKey::plain) to an output stream, between quotes.
+        template <typename OutputStream>
+        void put_plain_key(OutputStream &os, const char *name, size_t length)
+        {
+            rapidjson::PutReserve(os, length + 2);
+            rapidjson::PutUnsafe(os, '"');
+            for (size_t i = 0; i < length; ++i)
+            {
+                rapidjson::PutUnsafe(os, name[i]);
+            }
+            rapidjson::PutUnsafe(os, '"');
+        }
+
+        // Copy a formatted number to an output stream.
+        template <typename OutputStream>
+        void put_number(OutputStream &os, const char *number, size_t length)
+        {
+            rapidjson::PutReserve(os, length);
+            for (size_t i = 0; i < length; ++i)
+            {
+                rapidjson::PutUnsafe(os, number[i]);
+            }
+        }
+
+        // rapidjson::Writer that writes plain keys as they are, skipping the escape checks
+        // Key() does on every byte, and numbers formatted by json_number.hpp.
+        template <typename OutputStream>
+        class CompactWriter : public rapidjson::Writer<OutputStream>
+        {
+        public:
+            explicit CompactWriter(OutputStream &os) : rapidjson::Writer<OutputStream>(os) {}
+
+            bool PlainKey(const char *name, size_t length)
+            {
+                this->Prefix(rapidjson::kStringType);
+                put_plain_key(*this->os_, name, length);
+                return this->EndValue(true);
+            }
+            bool PlainNumber(const char *number, size_t length)
+            {
+                this->Prefix(rapidjson::kNumberType);
+                put_number(*this->os_, number, length);
+                return this->EndValue(true);
+            }
+        };
+
+        // rapidjson::PrettyWriter that writes plain keys and numbers as they are, like
+        // CompactWriter.
+        template <typename OutputStream>
+        class IndentWriter : public rapidjson::PrettyWriter<OutputStream>
+        {
+        public:
+            explicit IndentWriter(OutputStream &os) : rapidjson::PrettyWriter<OutputStream>(os) {}
+
+            bool PlainKey(const char *name, size_t length)
+            {
+                this->PrettyPrefix(rapidjson::kStringType);
+                put_plain_key(*this->os_, name, length);
+                return this->EndValue(true);
+            }
+            bool PlainNumber(const char *number, size_t length)
+            {
+                this->PrettyPrefix(rapidjson::kNumberType);
+                put_number(*this->os_, number, length);
+                return this->EndValue(true);
+            }
+        };
+
         // JSON writer archive based on rapidjson.
+        //
+        // \tparam Writer: CompactWriter for compact JSON, IndentWriter for indented JSON
+        template <typename Writer>
         class RapidJsonWriterArchive
         {
         public:
-            explicit RapidJsonWriterArchive(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer_) : _writer(writer_) {}
+            explicit RapidJsonWriterArchive(Writer &writer_) : _writer(writer_) {}
             void class_version(const int class_version_)
             {
                 if (class_version_ > 0)
                 {
-                    _writer.Key("_objver");
+                    writeKey("_objver");
                     _writer.Int(class_version_);
                 }
             }
             template <typename T>
-            void ez(const char *key, T t, int /*object_version_supported*/)
+            void ez(JsonKey key, T t, int /*object_version_supported*/)
             {
                 ez(key, t);
             }
-            void ez(const char *key, bool b)
+            void ez(JsonKey key, bool b)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez(b);
             }
-            void ez(const char *key, int8_t i8)
+            void ez(JsonKey key, int8_t i8)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez(i8);
             }
-            void ez(const char *key, int16_t i16)
+            void ez(JsonKey key, int16_t i16)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez(i16);
             }
-            void ez(const char *key, int32_t i32)
+            void ez(JsonKey key, int32_t i32)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez(i32);
             }
-            void ez(const char *key, int64_t i64)
+            void ez(JsonKey key, int64_t i64)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez(i64);
             }
-            void ez(const char *key, uint8_t u8)
+            void ez(JsonKey key, uint8_t u8)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez(u8);
             }
-            void ez(const char *key, uint16_t u16)
+            void ez(JsonKey key, uint16_t u16)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez(u16);
             }
-            void ez(const char *key, uint32_t u32)
+            void ez(JsonKey key, uint32_t u32)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez(u32);
             }
-            void ez(const char *key, uint64_t u64)
+            void ez(JsonKey key, uint64_t u64)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez(u64);
             }
             // Rapidjson doesn't support "float" (only "double"), so leave this out.
-            // void ez(const char *key, float f)
-            void ez(const char *key, double d)
+            // void ez(JsonKey key, float f)
+            void ez(JsonKey key, double d)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez(d);
             }
-            void ez(const char *key, const std::string &s)
+            void ez(JsonKey key, const std::string &s)
+            {
+                writeKey(key);
+                _ez(s);
+            }
+#if EASY_SERIALIZE_HAS_STRING_VIEW
+            void ez(JsonKey key, std::string_view s)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez(s);
             }
+#endif
             template <typename T>
-            void ez_enum(const char *key, T e, T /* enum_value_N */)
+            void ez(JsonKey key, Lazy<T> &lazy)
             {
-                _writer.Key(key);
-                _ez_enum(e);
+                writeKey(key);
+                _ez_lazy(lazy);
             }
             template <typename T>
-            void ez_enum(const char *key, T e, T enum_value_N, int /*object_version_supported*/)
+            void ez_enum(JsonKey key, T e, T enum_value_N)
+            {
+                writeKey(key);
+                _ez_enum(e, get_enum_names(enum_value_N));
+            }
+            template <typename T>
+            void ez_enum(JsonKey key, T e, T enum_value_N, int /*object_version_supported*/)
             {
                 ez_enum(key, e, enum_value_N);
             }
             template <typename T>
-            void ez_object(const char *key, T &o)
+            void ez_object(JsonKey key, T &o)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez_object(o);
             }
             template <typename T>
-            void ez_object(const char *key, T t, int /*object_version_supported*/)
+            void ez_object(JsonKey key, T t, int /*object_version_supported*/)
             {
                 ez_object(key, t);
             }
             template <typename T>
-            void ez_vector(const char *key, std::vector<T> &v)
+            void ez_vector(JsonKey key, std::vector<T> &v)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez_vector(v);
             }
             template <typename T>
-            void ez_vector(const char *key, std::vector<T> v, int /*object_version_supported*/)
+            void ez_vector(JsonKey key, std::vector<T> v, int /*object_version_supported*/)
             {
                 ez_vector(key, v);
             }
             template <typename T>
-            void ez_vector_enums(const char *key, std::vector<T> &v, T /*enum_value_N*/)
+            void ez_vector_enums(JsonKey key, std::vector<T> &v, T enum_value_N)
             {
-                _writer.Key(key);
-                _ez_vector_enums(v);
+                writeKey(key);
+                _ez_vector_enums(v, get_enum_names(enum_value_N));
             }
             template <typename T>
-            void ez_vector_enums(const char *key, std::vector<T> &v, T enum_value_N, int /*object_version_supported*/)
+            void ez_vector_enums(JsonKey key, std::vector<T> &v, T enum_value_N, int /*object_version_supported*/)
             {
                 ez_vector_enums(key, v, enum_value_N);
             }
             template <typename T>
-            void ez_vector_objects(const char *key, std::vector<T> &v)
+            void ez_vector_objects(JsonKey key, std::vector<T> &v)
             {
-                _writer.Key(key);
+                writeKey(key);
                 _ez_vector_objects(v);
             }
             template <typename T>
-            void ez_vector_objects(const char *key, std::vector<T> v, int /*object_version_supported*/)
+            void ez_vector_objects(JsonKey key, std::vector<T> v, int /*object_version_supported*/)
             {
                 ez_vector_objects(key, v);
             }
@@ -150,70 +243,148 @@ namespace easy_serialize
             RapidJsonWriterArchive(const RapidJsonWriterArchive &) = delete;
             RapidJsonWriterArchive &operator=(const RapidJsonWriterArchive &) = delete;
 
-            template <typename T>
-            friend void to_json_buffer(rapidjson::StringBuffer &string_buffer, T &obj,
+            template <typename OutputStream, typename Write>
+            friend void write_json(OutputStream &os, JsonIndent json_indent, Write write);
+            template <typename OutputStream, typename T>
+            friend void to_json_stream(OutputStream &os, T &obj,
                                        JsonIndent json_indent);
-            template <typename T>
-            friend void to_json_buffer_vector_objects(rapidjson::StringBuffer &string_buffer, std::vector<T> &v,
+            template <typename OutputStream, typename T>
+            friend void to_json_stream_vector_objects(OutputStream &os, std::vector<T> &v,
                                                       JsonIndent json_indent);
-            template <typename T>
-            friend void to_json_buffer_vector_enums(rapidjson::StringBuffer &string_buffer, std::vector<T> &v,
+            template <typename OutputStream, typename T>
+            friend void to_json_stream_vector_enums(OutputStream &os, std::vector<T> &v,
                                                     JsonIndent json_indent);
-            template <typename T>
-            friend void to_json_buffer_vector(rapidjson::StringBuffer &string_buffer, std::vector<T> &v,
+            template <typename OutputStream, typename T>
+            friend void to_json_stream_vector_enums(OutputStream &os, std::vector<T> &v,
+                                                    T enum_value_N, JsonIndent json_indent);
+            template <typename OutputStream, typename T>
+            friend void to_json_stream_vector(OutputStream &os, std::vector<T> &v,
                                               JsonIndent json_indent);
 
         private:
+            void writeKey(const JsonKey &key)
+            {
+                if (key.plain)
+                {
+                    _writer.PlainKey(key.name, key.length);
+                }
+                else
+                {
+                    _writer.Key(key.name, static_cast<rapidjson::SizeType>(key.length));
+                }
+            }
             void _ez(bool b)
             {
                 _writer.Bool(b);
             }
             void _ez(int8_t i8)
             {
-                _writer.Int(i8);
+                writeInt(i8);
             }
             void _ez(int16_t i16)
             {
-                _writer.Int(i16);
+                writeInt(i16);
             }
             void _ez(int32_t i32)
             {
-                _writer.Int(i32);
+                writeInt(i32);
             }
             void _ez(int64_t i64)
             {
-                _writer.Int64(i64);
+                writeInt(i64);
             }
             void _ez(uint8_t u8)
             {
-                _writer.Uint(u8);
+                writeUint(u8);
             }
             void _ez(uint16_t u16)
             {
-                _writer.Uint(u16);
+                writeUint(u16);
             }
             void _ez(uint32_t u32)
             {
-                _writer.Uint(u32);
+                writeUint(u32);
             }
             void _ez(uint64_t u64)
             {
-                _writer.Uint64(u64);
+                writeUint(u64);
             }
+            // Shortest round trip (see write_double). rapidjson writes NaN and infinities, as its
+            // write flags allow.
             void _ez(double d)
             {
-                _writer.Double(d);
+                if (std::isfinite(d))
+                {
+                    char number[max_number_length];
+                    _writer.PlainNumber(number, static_cast<size_t>(write_double(d, number) - number));
+                }
+                else
+                {
+                    _writer.Double(d);
+                }
+            }
+            void writeInt(int64_t i)
+            {
+                char number[max_number_length];
+                _writer.PlainNumber(number, static_cast<size_t>(write_int64(i, number) - number));
+            }
+            void writeUint(uint64_t u)
+            {
+                char number[max_number_length];
+                _writer.PlainNumber(number, static_cast<size_t>(write_uint64(u, number) - number));
             }
             void _ez(const std::string &s)
             {
                 _writer.String(s.c_str());
             }
+#if EASY_SERIALIZE_HAS_STRING_VIEW
+            void _ez(std::string_view s)
+            {
+                _writer.String(s.data(), static_cast<rapidjson::SizeType>(s.size()));
+            }
+#endif
+            // Copy out JSON text that hasn't been decoded, as is (it isn't indented).
+            template <typename T>
+            void _ez_lazy(Lazy<T> &lazy)
+            {
+                if (!lazy.is_decoded())
+                {
+                    _writer.RawValue(lazy.raw().data(), lazy.raw().size(),
+                                     Lazy<T>::is_array ? rapidjson::kArrayType : rapidjson::kObjectType);
+                }
+                else
+                {
+                    _ez_decoded(lazy.get());
+                }
+            }
+            template <typename T>
+            void _ez_decoded(T &o)
+            {
+                _ez_object(o);
+            }
+            template <typename T>
+            void _ez_decoded(std::vector<T> &v)
+            {
+                _ez_vector_objects(v);
+            }
             template <typename T>
             void _ez_enum(T &e)
             {
                 _writer.String(to_string(e));
             }
             template <typename T>
+            void _ez_enum(T e, const EnumNames<T> &names)
+            {
+                if (static_cast<size_t>(e) < names.size())
+                {
+                    _writer.String(names.name(e), static_cast<rapidjson::SizeType>(names.length(e)));
+                }
+                else
+                {
+                    _ez_enum(e);
+                }
+            }
+            template <typename T>
             void _ez_object(T &o)
             {
                 _writer.StartObject();
@@ -241,6 +412,16 @@ namespace easy_serialize
                 _writer.EndArray();
             }
             template <typename T>
+            void _ez_vector_enums(std::vector<T> &v, const EnumNames<T> &names)
+            {
+                _writer.StartArray();
+                for (const auto e : v)
+                {
+                    _ez_enum(e, names);
+                }
+                _writer.EndArray();
+            }
+            template <typename T>
             void _ez_vector_objects(std::vector<T> &v)
             {
                 _writer.StartArray();
@@ -252,67 +433,98 @@ namespace easy_serialize
                 }
                 _writer.EndArray();
             }
-            rapidjson::PrettyWriter<rapidjson::StringBuffer> &_writer;
+            Writer &_writer;
         };
 
-        // Create UTF-8 JSON from object in memory buffer.
+        // Write JSON to an output stream with the writer for the indent: compact JSON goes
+        // through CompactWriter (a rapidjson::Writer), which has no formatting to do, indented
+        // JSON through IndentWriter (a rapidjson::PrettyWriter).
         //
-        // \param string_buffer: rapidjson StringBuffer output stream buffer.
+        // \param os: rapidjson output stream
+        // \param json_indent: JSON indent formatting
+        // \param write: called with the archive to write the value
+        template <typename OutputStream, typename Write>
+        void write_json(OutputStream &os, JsonIndent json_indent, Write write)
+        {
+            if (json_indent == JsonIndent::compact)
+            {
+                CompactWriter<OutputStream> writer(os);
+                RapidJsonWriterArchive<CompactWriter<OutputStream>> a(writer);
+                write(a);
+            }
+            else
+            {
+                IndentWriter<OutputStream> writer(os);
+                writer.SetIndent(' ', get_num_spaces(json_indent));
+                RapidJsonWriterArchive<IndentWriter<OutputStream>> a(writer);
+                write(a);
+            }
+        }
+
+        // Write UTF-8 JSON of object to an output stream.
+        //
+        // \param os: rapidjson output stream
         // \param obj: object to JSON
         // \param json_indent: JSON indent formatting
-        template <typename T>
-        void to_json_buffer(rapidjson::StringBuffer &string_buffer, T &obj,
+        template <typename OutputStream, typename T>
+        void to_json_stream(OutputStream &os, T &obj,
                             JsonIndent json_indent)
         {
-            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(string_buffer);
-            RapidJsonWriterArchive a(writer);
-            writer.SetIndent(' ', get_num_spaces(json_indent));
-            a._ez_object(obj);
+            write_json(os, json_indent, [&obj](auto &a)
+                       { a._ez_object(obj); });
         }
 
-        // Create UTF-8 JSON from vector of objects in memory buffer.
+        // Write UTF-8 JSON of vector of objects to an output stream.
         //
-        // \param string_buffer: rapidjson::StringBuffer
+        // \param os: rapidjson output stream
         // \param v: vector of objects
         // \param json_indent: JSON indent formatting
-        template <typename T>
-        void to_json_buffer_vector_objects(rapidjson::StringBuffer &string_buffer, std::vector<T> &v,
+        template <typename OutputStream, typename T>
+        void to_json_stream_vector_objects(OutputStream &os, std::vector<T> &v,
                                            JsonIndent json_indent)
         {
-            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(string_buffer);
-            writer.SetIndent(' ', get_num_spaces(json_indent));
-            RapidJsonWriterArchive a(writer);
-            a._ez_vector_objects(v);
+            write_json(os, json_indent, [&v](auto &a)
+                       { a._ez_vector_objects(v); });
         }
 
-        // Create UTF-8 JSON from vector of supported fundamental types in memory buffer.
+        // Write UTF-8 JSON of vector of supported fundamental types to an output stream.
         //
-        // \param string_buffer: rapidjson::StringBuffer
+        // \param os: rapidjson output stream
         // \param obj: object to JSON
         // \param json_indent: JSON indent formatting
-        template <typename T>
-        void to_json_buffer_vector(rapidjson::StringBuffer &string_buffer, std::vector<T> &v,
+        template <typename OutputStream, typename T>
+        void to_json_stream_vector(OutputStream &os, std::vector<T> &v,
                                    JsonIndent json_indent)
         {
-            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(string_buffer);
-            writer.SetIndent(' ', get_num_spaces(json_indent));
-            RapidJsonWriterArchive a(writer);
-            a._ez_vector(v);
+            write_json(os, json_indent, [&v](auto &a)
+                       { a._ez_vector(v); });
         }
 
-        // Create UTF-8 JSON from vector of enums in memory buffer.
+        // Write UTF-8 JSON of vector of enums to an output stream.
         //
-        // \param string_buffer: rapidjson::StringBuffer
+        // \param os: rapidjson output stream
         // \param obj: object to JSON
         // \param json_indent: JSON indent formatting
-        template <typename T>
-        void to_json_buffer_vector_enums(rapidjson::StringBuffer &string_buffer, std::vector<T> &v,
+        template <typename OutputStream, typename T>
+        void to_json_stream_vector_enums(OutputStream &os, std::vector<T> &v,
                                          JsonIndent json_indent)
         {
-            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(string_buffer);
-            writer.SetIndent(' ', get_num_spaces(json_indent));
-            RapidJsonWriterArchive a(writer);
-            a._ez_vector_enums(v);
+            write_json(os, json_indent, [&v](auto &a)
+                       { a._ez_vector_enums(v); });
+        }
+
+        // Write UTF-8 JSON of vector of enums to an output stream, using the enum's cached names.
+        //
+        // \param os: rapidjson output stream
+        // \param v: vector of enums
+        // \param enum_value_N: last enum value (not a valid value)
+        // \param json_indent: JSON indent formatting
+        template <typename OutputStream, typename T>
+        void to_json_stream_vector_enums(OutputStream &os, std::vector<T> &v,
+                                         T enum_value_N, JsonIndent json_indent)
+        {
+            write_json(os, json_indent, [&v, enum_value_N](auto &a)
+                       { a._ez_vector_enums(v, get_enum_names(enum_value_N)); });
         }
     } // namespace rapidjson_impl
 } // namespace easy_serialize
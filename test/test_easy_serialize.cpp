@@ -2,11 +2,30 @@
 
 #include "easy_serialize/json_file_reader.hpp"
 #include "easy_serialize/json_file_writer.hpp"
+#include "easy_serialize/json_lines_parallel_reader.hpp"
+#include "easy_serialize/json_lines_reader.hpp"
+#include "easy_serialize/json_push_reader.hpp"
 #include "easy_serialize/json_reader.hpp"
 #include "easy_serialize/json_writer.hpp"
+#include "easy_serialize/lazy.hpp"
 
+#if EASY_SERIALIZE_HAS_MMAP
+#include <sys/stat.h>
+#endif
+#if EASY_SERIALIZE_HAS_ATOMIC_RENAME
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
 #include <iostream>
 #include <limits>
+#include <random>
+#include <thread>
 #include <vector>
 
 enum OrangeJuicePulpLevel
@@ -92,6 +111,19 @@ public:
   }
 };
 
+// Y and Z ask for the same fields every time, so the DOM reader can read them through a schema.
+namespace easy_serialize
+{
+  template <>
+  struct HasFixedFields<Y> : std::true_type
+  {
+  };
+  template <>
+  struct HasFixedFields<Z> : std::true_type
+  {
+  };
+} // namespace easy_serialize
+
 int test_writer_mins()
 {
   Z z;
@@ -415,6 +447,13 @@ int test_to_from_vector_enums()
               << "\"\nexpected: " << expected
               << "\nactual: " << actual << "\n";
   }
+  const auto actual_with_names = easy_serialize::to_json_string_vector_enums(v, OrangeJuicePulpLevel::N);
+  if (expected != actual_with_names)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, expected: " << expected
+              << "\nactual: " << actual_with_names << "\n";
+  }
   const std::string filename = "test_vector_enums.json";
   const auto file_write_status = easy_serialize::to_json_file_vector_enums(filename, v);
   if (!file_write_status)
@@ -446,6 +485,330 @@ int test_to_from_vector_enums()
     }
   }
   std::remove(filename.c_str());
+  // The names are looked up for the enum_value_N of each call, not just the first.
+  std::vector<OrangeJuicePulpLevel> v3;
+  const auto narrow_status =
+      easy_serialize::from_json_string_vector_enums("[\"medium\", \"high\"]", v3, OrangeJuicePulpLevel::High);
+  const auto wide_status =
+      easy_serialize::from_json_string_vector_enums("[\"medium\", \"high\"]", v3, OrangeJuicePulpLevel::N);
+  if (narrow_status || !wide_status || v3.size() != 2)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, narrow error: \"" << narrow_status.get_error_message()
+              << "\", wide error: \"" << wide_status.get_error_message() << "\"\n";
+  }
+  return num_fails;
+}
+
+int test_writer_compact()
+{
+  int num_fails = 0;
+  Z z;
+  z.i64 = std::numeric_limits<int64_t>::min();
+  z.u64 = std::numeric_limits<uint64_t>::max();
+  z.b = true;
+  z.d = 0.5;
+  z.s = "a \"quoted\" string";
+  z.pulp_level = OrangeJuicePulpLevel::Medium;
+  z.y = {1.0, -2.5};
+  z.v_y = {{0.0, 1.0}, {2.0, 3.0}};
+  z.v_e = {OrangeJuicePulpLevel::High, OrangeJuicePulpLevel::Low};
+  z.v_s = {"strings", ""};
+  const std::string expected =
+      R"zzz({"i8":0,"i16":0,"i32":0,"i64":-9223372036854775808,"u8":0,"u16":0,"u32":0,)zzz"
+      R"zzz("u64":18446744073709551615,"b":true,"d":0.5,"s":"a \"quoted\" string","pulp level":"medium",)zzz"
+      R"zzz("y":{"d":1.0,"d2":-2.5},"v_y":[{"d":0.0,"d2":1.0},{"d":2.0,"d2":3.0}],"v_e":["high","low"],)zzz"
+      R"zzz("v_s":["strings",""]})zzz";
+  const auto actual = easy_serialize::to_json_string(z, easy_serialize::JsonIndent::compact);
+  if (expected != actual)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, expected: " << expected
+              << "\nactual: " << actual << "\n";
+  }
+  const std::vector<std::string> expected_str = {
+      R"zzz([{"d":0.0,"d2":1.0},{"d":2.0,"d2":3.0}])zzz",
+      R"zzz(["strings",""])zzz",
+      R"zzz(["high","low"])zzz",
+      R"zzz(["high","low"])zzz"};
+  const std::vector<std::string> actual_str = {
+      easy_serialize::to_json_string_vector_objects(z.v_y, easy_serialize::JsonIndent::compact),
+      easy_serialize::to_json_string_vector(z.v_s, easy_serialize::JsonIndent::compact),
+      easy_serialize::to_json_string_vector_enums(z.v_e, easy_serialize::JsonIndent::compact),
+      easy_serialize::to_json_string_vector_enums(z.v_e, OrangeJuicePulpLevel::N,
+                                                  easy_serialize::JsonIndent::compact)};
+  for (size_t i = 0; i < expected_str.size(); ++i)
+  {
+    if (expected_str[i] != actual_str[i])
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, expected: " << expected_str[i]
+                << "\nactual: " << actual_str[i] << "\n";
+    }
+  }
+  return num_fails;
+}
+
+// Output stream that splits JSON into lines, like a user stream writing to a socket would
+// split it into packets.
+struct LinesOutputStream
+{
+  typedef char Ch;
+  std::vector<std::string> lines{""};
+  size_t num_flushes = 0;
+
+  void Put(Ch c)
+  {
+    if (c == '\n')
+    {
+      lines.emplace_back();
+    }
+    else
+    {
+      lines.back().push_back(c);
+    }
+  }
+  void Flush() { ++num_flushes; }
+};
+
+int test_writer_streams()
+{
+  int num_fails = 0;
+  std::vector<Y> v_y = {{1.0, 2.0}, {3.0, 4.5}};
+  const std::string expected = R"zzz([{"d":1.0,"d2":2.0},{"d":3.0,"d2":4.5}])zzz";
+
+  // Appends, keeping what's there.
+  std::string json = "POST ";
+  easy_serialize::to_json_string_vector_objects(v_y, json, easy_serialize::JsonIndent::compact);
+  if (json != "POST " + expected)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, actual: " << json << "\n";
+  }
+  json.clear();
+  easy_serialize::to_json_string(v_y[1], json);
+  if (json != easy_serialize::to_json_string(v_y[1]))
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, actual: " << json << "\n";
+  }
+
+  // Fits exactly, then one byte short.
+  for (const size_t size : {expected.size(), expected.size() - 1})
+  {
+    std::vector<char> buffer(size, '\0');
+    easy_serialize::SpanOutputStream os(buffer.data(), buffer.size());
+    easy_serialize::to_json_stream_vector_objects(os, v_y, easy_serialize::JsonIndent::compact);
+    const bool overflowed = size < expected.size();
+    if (os.overflowed() != overflowed || os.size() != expected.size() ||
+        std::string(buffer.data(), buffer.size()) != expected.substr(0, size))
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, size: " << size
+                << ", overflowed: " << os.overflowed() << ", needs: " << os.size() << "\n";
+    }
+  }
+
+  LinesOutputStream lines;
+  easy_serialize::to_json_stream(lines, v_y[0]);
+  const std::vector<std::string> expected_lines = {"{", R"zzz(  "d": 1.0,)zzz", R"zzz(  "d2": 2.0)zzz", "}"};
+  if (lines.lines != expected_lines || lines.num_flushes == 0)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, lines: " << lines.lines.size()
+              << ", flushes: " << lines.num_flushes << "\n";
+  }
+  return num_fails;
+}
+
+class EscapedKeys
+{
+public:
+  int32_t a = 1;
+  int32_t b = 2;
+  int32_t c = 3;
+  std::string runtime_key = "run\\time";
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.ez("plain", a);
+    ar.ez("\"quoted\"\t", b);
+    ar.ez(runtime_key.c_str(), c);
+  }
+};
+
+static_assert(easy_serialize::JsonKey("pulp level").plain, "plain key");
+static_assert(!easy_serialize::JsonKey("\"quoted\"").plain, "key with quotes");
+
+int test_writer_keys()
+{
+  int num_fails = 0;
+  EscapedKeys keys;
+  const std::string expected_compact = R"zzz({"plain":1,"\"quoted\"\t":2,"run\\time":3})zzz";
+  const std::string expected_indented = R"zzz({
+  "plain": 1,
+  "\"quoted\"\t": 2,
+  "run\\time": 3
+})zzz";
+  const auto actual_compact = easy_serialize::to_json_string(keys, easy_serialize::JsonIndent::compact);
+  const auto actual_indented = easy_serialize::to_json_string(keys);
+  if (expected_compact != actual_compact || expected_indented != actual_indented)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, actual: " << actual_compact << "\n"
+              << actual_indented << "\n";
+  }
+  EscapedKeys read_keys;
+  read_keys.a = read_keys.b = read_keys.c = 0;
+  const auto status = easy_serialize::from_json_string(actual_compact, read_keys);
+  if (!status || read_keys.a != 1 || read_keys.b != 2 || read_keys.c != 3)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << status.get_error_message() << "'\n";
+  }
+  return num_fails;
+}
+
+int test_writer_numbers()
+{
+  int num_fails = 0;
+  std::vector<double> v = {0.0, -0.0, 1.0, 0.1, 87.25, 1e20, 1e21, 1e-6, 1.5e-7, 0.001234, 1.0 / 3.0, -1e100};
+  const std::string expected =
+      "[0.0,-0.0,1.0,0.1,87.25,100000000000000000000.0,1e21,0.000001,1.5e-7,0.001234,0.3333333333333333,-1e100]";
+  const auto actual = easy_serialize::to_json_string_vector(v, easy_serialize::JsonIndent::compact);
+  if (expected != actual)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, expected: " << expected << "\nactual: " << actual << "\n";
+  }
+
+  // Every finite double reads back exactly.
+  std::mt19937_64 rng(20);
+  std::vector<double> doubles;
+  while (doubles.size() < 100000)
+  {
+    const uint64_t bits = rng();
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    if (std::isfinite(d))
+    {
+      doubles.push_back(d);
+    }
+  }
+  doubles.push_back(std::numeric_limits<double>::denorm_min());
+  doubles.push_back(std::numeric_limits<double>::max());
+  std::vector<double> read_doubles;
+  const auto status = easy_serialize::from_json_string_vector(
+      easy_serialize::to_json_string_vector(doubles, easy_serialize::JsonIndent::compact), read_doubles);
+  if (!status || read_doubles.size() != doubles.size() ||
+      std::memcmp(read_doubles.data(), doubles.data(), doubles.size() * sizeof(double)) != 0)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, doubles don't read back, error: '"
+              << status.get_error_message() << "'\n";
+  }
+
+  std::vector<int64_t> ints = {0, 9, 10, 99, 100, -1, -10, std::numeric_limits<int64_t>::min(),
+                               std::numeric_limits<int64_t>::max()};
+  for (int i = 0; i < 1000; ++i)
+  {
+    ints.push_back(static_cast<int64_t>(rng()) >> (rng() % 64));
+  }
+  std::string expected_ints = "[";
+  for (const auto i : ints)
+  {
+    expected_ints += (expected_ints.size() > 1 ? "," : "") + std::to_string(i);
+  }
+  expected_ints += "]";
+  const auto actual_ints = easy_serialize::to_json_string_vector(ints, easy_serialize::JsonIndent::compact);
+  if (expected_ints != actual_ints)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, expected: " << expected_ints
+              << "\nactual: " << actual_ints << "\n";
+  }
+  return num_fails;
+}
+
+int test_write_file()
+{
+  int num_fails = 0;
+  const std::string filename = "test_write_file.json";
+  // Many times the size of the file buffer.
+  std::vector<Y> v_y(20000);
+  for (size_t i = 0; i < v_y.size(); ++i)
+  {
+    v_y[i] = {static_cast<double>(i), 0.5};
+  }
+  for (const auto file_write : {easy_serialize::JsonFileWrite::overwrite, easy_serialize::JsonFileWrite::atomic})
+  {
+    const auto status = easy_serialize::to_json_file_vector_objects(
+        filename, v_y, easy_serialize::JsonIndent::two_spaces, file_write);
+    std::vector<Y> actual;
+    const auto read_status = easy_serialize::from_json_file_vector_objects(filename, actual);
+    if (!status || !read_status || easy_serialize::to_json_string_vector_objects(actual) !=
+                                       easy_serialize::to_json_string_vector_objects(v_y))
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << status.get_error_message()
+                << "', read error: '" << read_status.get_error_message() << "'\n";
+    }
+    std::FILE *tmp = std::fopen((filename + ".tmp").c_str(), "rb");
+    if (tmp)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, temporary file left behind\n";
+      std::fclose(tmp);
+    }
+#if EASY_SERIALIZE_HAS_ATOMIC_RENAME
+    // No uniquely named temporary file is left behind either.
+    DIR *dir = opendir(".");
+    while (dirent *entry = dir ? readdir(dir) : nullptr)
+    {
+      if (std::strncmp(entry->d_name, (filename + ".").c_str(), filename.size() + 1) == 0)
+      {
+        ++num_fails;
+        std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, temporary file left behind: " << entry->d_name << "\n";
+      }
+    }
+    if (dir)
+    {
+      closedir(dir);
+    }
+#endif
+
+    const auto missing_status = easy_serialize::to_json_file(
+        "no_such_directory/" + filename, v_y[0], easy_serialize::JsonIndent::two_spaces, file_write);
+    if (missing_status || missing_status.get_error_message() != "File opening failed.")
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << missing_status.get_error_message()
+                << "'\n";
+    }
+  }
+#if EASY_SERIALIZE_HAS_ATOMIC_RENAME
+  // The new file keeps the permissions of the one it replaces.
+  chmod(filename.c_str(), 0600);
+  const auto mode_status = easy_serialize::to_json_file(filename, v_y[0], easy_serialize::JsonIndent::two_spaces,
+                                                        easy_serialize::JsonFileWrite::atomic);
+  struct stat file_stat;
+  if (!mode_status || stat(filename.c_str(), &file_stat) != 0 || (file_stat.st_mode & 0777) != 0600)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << mode_status.get_error_message() << "'\n";
+  }
+#endif
+  std::remove(filename.c_str());
+#ifdef __linux__
+  // Every write fails with ENOSPC.
+  const auto full_status = easy_serialize::to_json_file_vector_objects("/dev/full", v_y);
+  if (full_status || full_status.get_error_message() != "File writing error.")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << full_status.get_error_message() << "'\n";
+  }
+#endif
   return num_fails;
 }
 
@@ -455,22 +818,41 @@ struct TestCase
   std::string expected_error;
 };
 
+int check_test_case(int line, const char *function, const char *reader, const TestCase &tc,
+                    const easy_serialize::EasySerializeStatus &status)
+{
+  if (tc.expected_error != status.get_error_message())
+  {
+    std::cerr << __FILE__ << ":" << line << ", FAIL, " << function << "(json: '" << tc.json
+              << "'), " << reader << ", expected: '" << tc.expected_error
+              << "', actual: '" << status.get_error_message()
+              << "'\n";
+    return 1;
+  }
+  return 0;
+}
+
 template <class T>
 int run_test_cases(int line, const char *function, const std::vector<TestCase> &test_cases)
 {
   int num_fails = 0;
+  // Shared across test cases, so each read after an error reuses a dirty context.
+  easy_serialize::JsonReaderContext context(64);
   for (const auto &tc : test_cases)
   {
     T tb;
-    const auto status = easy_serialize::from_json_string(tc.json, tb);
-    if (tc.expected_error != status.get_error_message())
-    {
-      ++num_fails;
-      std::cerr << __FILE__ << ":" << line << ", FAIL, " << function << "(json: '" << tc.json
-                << "'), expected: '" << tc.expected_error
-                << "', actual: '" << status.get_error_message()
-                << "'\n";
-    }
+    num_fails += check_test_case(line, function, "from_json_string", tc,
+                                 easy_serialize::from_json_string(tc.json, tb));
+    T tb_streaming;
+    num_fails += check_test_case(line, function, "from_json_string_streaming", tc,
+                                 easy_serialize::from_json_string_streaming(tc.json, tb_streaming));
+    T tb_insitu;
+    std::vector<char> buffer(tc.json, tc.json + std::strlen(tc.json));
+    num_fails += check_test_case(line, function, "from_json_buffer_insitu", tc,
+                                 easy_serialize::from_json_buffer_insitu(buffer.data(), buffer.size(), tb_insitu));
+    T tb_context;
+    num_fails += check_test_case(line, function, "from_json_string with context", tc,
+                                 easy_serialize::from_json_string(tc.json, tb_context, context));
   }
   return num_fails;
 }
@@ -709,6 +1091,13 @@ int test_read_enum()
       {"{\"a\": 0.0}", "[\"k\"] key not found"},
       {"{\"k\": false}", "[\"k\"] expected a string"},
       {"{\"k\": \"dude\"}", "[\"k\"] expected an enum type"},
+      {"{\"k\": \"\"}", "[\"k\"] expected an enum type"},
+      {"{\"k\": \"hig\"}", "[\"k\"] expected an enum type"},
+      {"{\"k\": \"highh\"}", "[\"k\"] expected an enum type"},
+      {"{\"k\": \"high\\u0000\"}", "[\"k\"] expected an enum type"},
+      {"{\"k\": \"low\"}", ""},
+      {"{\"k\": \"medium\"}", ""},
+      {"{\"k\": \"high\"}", ""},
   };
   return RUN_TEST_CASES(TestEnum, test_cases);
 }
@@ -765,6 +1154,13 @@ struct TestVersionedObject
     ar.ez("i", i, 1);
   }
 };
+namespace easy_serialize
+{
+  template <>
+  struct HasFixedFields<TestVersionedObject> : std::true_type
+  {
+  };
+} // namespace easy_serialize
 int test_read_versioned_object()
 {
   std::vector<TestCase> test_cases = {
@@ -777,16 +1173,1760 @@ int test_read_versioned_object()
   return RUN_TEST_CASES(TestVersionedObject, test_cases);
 }
 
+int test_read_parse_errors()
+{
+  std::vector<TestCase> test_cases = {
+      {"", "The document is empty."},
+      {"{\"k\": 1, \"x\": ]}", "Invalid value."},
+      {"{\"k\": true} {}", "The document root must not be followed by other values."},
+  };
+  return RUN_TEST_CASES(TestBool, test_cases);
+}
+
+// Records the most memory the streaming reader holds for members read ahead.
+class PoolProbe
+{
+public:
+  static size_t max_capacity;
+  double d = 0;
+  double d2 = 0;
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.ez("d", d);
+    ar.ez("d2", d2);
+    max_capacity = std::max(max_capacity, ar.capacity());
+  }
+};
+size_t PoolProbe::max_capacity = 0;
+
+int test_read_streaming()
+{
+  // Members out of serialize() order, unknown members and nesting.
+  const std::string json = R"zzz({
+  "v_s": ["we", "are", "strings"],
+  "unknown": {"a": [1, 2, {"b": null}]},
+  "v_e": ["medium", "high", "low"],
+  "v_y": [{"d2": 4.0, "d": 3.0}, {"d": 5.0, "d2": 6.0, "extra": "x"}],
+  "y": {"d": 1.0, "d2": 2.0},
+  "pulp level": "medium",
+  "s": "grr",
+  "d": 0.1,
+  "b": true,
+  "u64": 327,
+  "u32": 196,
+  "u16": 65535,
+  "u8": 255,
+  "i64": -9,
+  "i32": 42,
+  "i16": -32768,
+  "i8": 127
+})zzz";
+  int num_fails = 0;
+  Z expected;
+  const auto status = easy_serialize::from_json_string(json, expected);
+  Z actual;
+  const auto streaming_status = easy_serialize::from_json_string_streaming(json, actual);
+  const auto expected_str = easy_serialize::to_json_string(expected);
+  const auto actual_str = easy_serialize::to_json_string(actual);
+  if (!status || !streaming_status || expected_str != actual_str)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << streaming_status.get_error_message()
+              << "\"\nexpected: " << expected_str
+              << "\nactual: " << actual_str << "\n";
+  }
+
+  std::vector<Y> v_y;
+  const auto v_y_status = easy_serialize::from_json_string_vector_objects_streaming(
+      "[{\"d\": 1.0, \"d2\": 2.0}, {\"d\": 3.0, \"d2\": true}]", v_y);
+  if (v_y_status.get_error_message() != "[1][\"d2\"] expected a double")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << v_y_status.get_error_message()
+              << "\"\n";
+  }
+
+  std::vector<int32_t> v_i;
+  const auto v_i_status = easy_serialize::from_json_string_vector_streaming("[1, 2, 3]", v_i);
+  if (!v_i_status || v_i != std::vector<int32_t>{1, 2, 3})
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << v_i_status.get_error_message()
+              << "\"\n";
+  }
+
+  std::vector<OrangeJuicePulpLevel> v_e;
+  const auto v_e_status = easy_serialize::from_json_string_vector_enums_streaming(
+      "[\"low\", \"grr\"]", v_e, OrangeJuicePulpLevel::N);
+  if (v_e_status.get_error_message() != "[1] expected an enum type")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << v_e_status.get_error_message()
+              << "\"\n";
+  }
+
+  // Members read ahead are freed between objects, so the memory they take doesn't grow with
+  // the number of objects.
+  std::string many_y = "[";
+  const size_t num_many_y = 20000;
+  for (size_t i = 0; i < num_many_y; ++i)
+  {
+    many_y += (i ? ", " : "") + std::string("{\"unknown\": \"") + std::string(64, 'x') + "\", \"d2\": " +
+              std::to_string(i) + ", \"d\": 0.5}";
+  }
+  many_y += "]";
+  PoolProbe::max_capacity = 0;
+  std::vector<PoolProbe> v_probe;
+  const auto many_y_status = easy_serialize::from_json_string_vector_objects_streaming(many_y, v_probe);
+  if (!many_y_status || v_probe.size() != num_many_y || v_probe.back().d2 != double(num_many_y - 1) ||
+      PoolProbe::max_capacity == 0 || PoolProbe::max_capacity > 256 * 1024)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << many_y_status.get_error_message()
+              << "\", " << v_probe.size() << " objects read, " << PoolProbe::max_capacity << " bytes held\n";
+  }
+  return num_fails;
+}
+
+int test_read_insitu()
+{
+  const std::string json = R"zzz({
+  "i8": 127,
+  "i16": -32768,
+  "i32": 42,
+  "i64": -9,
+  "u8": 255,
+  "u16": 65535,
+  "u32": 196,
+  "u64": 327,
+  "b": true,
+  "d": 0.1,
+  "s": "escaped \"quotes\" \u00e9 and a\nnewline",
+  "pulp level": "medium",
+  "y": {
+    "d": 1.0,
+    "d2": 2.0
+  },
+  "v_y": [],
+  "v_e": [
+    "high"
+  ],
+  "v_s": [
+    "\t",
+    ""
+  ]
+})zzz";
+  int num_fails = 0;
+  Z expected;
+  const auto status = easy_serialize::from_json_string(json, expected);
+  // No null terminator, and trailing bytes past buffer_size must be ignored.
+  std::vector<char> buffer(json.begin(), json.end());
+  buffer.push_back('x');
+  Z actual;
+  const auto insitu_status = easy_serialize::from_json_buffer_insitu(buffer.data(), json.size(), actual);
+  const auto expected_str = easy_serialize::to_json_string(expected);
+  const auto actual_str = easy_serialize::to_json_string(actual);
+  if (!status || !insitu_status || expected_str != actual_str || actual.s != "escaped \"quotes\" \xc3\xa9 and a\nnewline")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << insitu_status.get_error_message()
+              << "\"\nexpected: " << expected_str
+              << "\nactual: " << actual_str << "\n";
+  }
+
+  std::string v_json = "[\"a\", \"b\\\\c\"]";
+  std::vector<std::string> v;
+  const auto v_status = easy_serialize::from_json_buffer_vector_insitu(&v_json[0], v_json.size(), v);
+  if (!v_status || v != std::vector<std::string>{"a", "b\\c"})
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << v_status.get_error_message()
+              << "\"\n";
+  }
+  return num_fails;
+}
+
+int test_read_context()
+{
+  int num_fails = 0;
+  // Start tiny so the pools have to grow.
+  easy_serialize::JsonReaderContext context(64);
+  for (size_t num_elements : {1, 1000, 10, 5000, 3})
+  {
+    std::vector<Y> expected(num_elements);
+    for (size_t i = 0; i < num_elements; ++i)
+    {
+      expected[i].d = static_cast<double>(i);
+      expected[i].d2 = -static_cast<double>(i);
+    }
+    const std::string json = easy_serialize::to_json_string_vector_objects(expected);
+    std::vector<Y> actual;
+    const auto status = easy_serialize::from_json_string_vector_objects(json, actual, context);
+    const auto actual_str = easy_serialize::to_json_string_vector_objects(actual);
+    if (!status || json != actual_str)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << num_elements << " elements, error: \""
+                << status.get_error_message() << "\"\n";
+    }
+
+    std::string insitu_json = json;
+    std::vector<Y> insitu_actual;
+    const auto insitu_status = easy_serialize::from_json_buffer_vector_objects_insitu(
+        &insitu_json[0], insitu_json.size(), insitu_actual, context);
+    if (!insitu_status || json != easy_serialize::to_json_string_vector_objects(insitu_actual))
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << num_elements << " elements, error: \""
+                << insitu_status.get_error_message() << "\"\n";
+    }
+  }
+
+  std::vector<OrangeJuicePulpLevel> v_e;
+  const auto v_e_status = easy_serialize::from_json_string_vector_enums("[\"high\", \"low\"]", v_e,
+                                                                        OrangeJuicePulpLevel::N, context);
+  if (!v_e_status || v_e != std::vector<OrangeJuicePulpLevel>{OrangeJuicePulpLevel::High, OrangeJuicePulpLevel::Low})
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << v_e_status.get_error_message() << "\"\n";
+  }
+
+  // Once warmed up, reading the same message again doesn't grow the pools.
+  std::vector<Y> message_v_y(100);
+  const std::string message = easy_serialize::to_json_string_vector_objects(message_v_y);
+  size_t warm_capacity = 0;
+  for (int i = 0; i < 1000; ++i)
+  {
+    std::vector<Y> v_y;
+    const auto status = easy_serialize::from_json_string_vector_objects(message, v_y, context);
+    if (i == 10)
+    {
+      warm_capacity = context.capacity();
+    }
+    if (!status || (i > 10 && context.capacity() != warm_capacity))
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, read " << i << ", capacity " << context.capacity()
+                << " after " << warm_capacity << ", error: \"" << status.get_error_message() << "\"\n";
+      break;
+    }
+  }
+  return num_fails;
+}
+
+struct TestAfterError
+{
+  int32_t a = 0;
+  int32_t b = 0;
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.ez("a", a);
+    ar.ez("b", b);
+  }
+};
+int test_read_error_path()
+{
+  int num_fails = 0;
+  const std::string json = "[{\"d\": 1.5, \"d2\": 2.5}, {\"d\": 3.5, \"d2\": \"x\"}]";
+  const std::string expected_error = "[1][\"d2\"] expected a double";
+  easy_serialize::JsonReaderContext context;
+  std::vector<Y> v;
+  const easy_serialize::EasySerializeStatus statuses[] = {
+      easy_serialize::from_json_string_vector_objects(json, v),
+      easy_serialize::from_json_string_vector_objects_streaming(json, v),
+      easy_serialize::from_json_string_vector_objects(json, v, context),
+  };
+  for (const auto &status : statuses)
+  {
+    // Copies keep the error, and the message can be asked for more than once.
+    const easy_serialize::EasySerializeStatus copy = status;
+    if (copy || copy.get_error_message() != expected_error || copy.get_error_message() != expected_error)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, expected: '" << expected_error << "', actual: '"
+                << copy.get_error_message() << "'\n";
+    }
+  }
+
+  // Reading stops at the first error.
+  TestAfterError t;
+  const auto status = easy_serialize::from_json_string("{\"a\": true, \"b\": 2}", t);
+  TestAfterError t_streaming;
+  const auto status_streaming = easy_serialize::from_json_string_streaming("{\"a\": true, \"b\": 2}", t_streaming);
+  if (status || status_streaming || t.b != 0 || t_streaming.b != 0)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, read past the first error\n";
+  }
+
+  // set_error_message() replaces a reader error.
+  easy_serialize::EasySerializeStatus replaced = easy_serialize::from_json_string("{\"a\": true}", t);
+  replaced.set_error_message("File opening failed.");
+  if (replaced || replaced.get_error_message() != "File opening failed.")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, actual: '" << replaced.get_error_message() << "'\n";
+  }
+  return num_fails;
+}
+
+#if EASY_SERIALIZE_HAS_STRING_VIEW
+class Route
+{
+public:
+  std::string_view service;
+  std::vector<std::string_view> tags;
+  int32_t priority = 0;
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.ez("service", service);
+    ar.ez_vector("tags", tags);
+    ar.ez("priority", priority);
+  }
+};
+
+int test_read_string_view()
+{
+  int num_fails = 0;
+  Route route;
+  route.service = "billing\n";
+  route.tags = {"a", "\"quoted\"", "a much longer tag that doesn't fit in a short string"};
+  route.priority = 3;
+  const std::string expected = easy_serialize::to_json_string(route);
+
+  std::string insitu_json = expected;
+  Route insitu_route;
+  const auto insitu_status = easy_serialize::from_json_buffer_insitu(&insitu_json[0], insitu_json.size(),
+                                                                     insitu_route);
+  if (!insitu_status || insitu_route.service != route.service || insitu_route.tags != route.tags ||
+      expected != easy_serialize::to_json_string(insitu_route))
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << insitu_status.get_error_message() << "\"\n";
+  }
+
+  easy_serialize::JsonReaderContext context;
+  Route context_route;
+  const auto context_status = easy_serialize::from_json_string(expected, context_route, context);
+  if (!context_status || expected != easy_serialize::to_json_string(context_route))
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << context_status.get_error_message() << "\"\n";
+  }
+
+  // Without a retained source the views would dangle.
+  const std::string expected_error = "[\"service\"] std::string_view needs in-situ parsing or a JsonReaderContext";
+  Route dom_route;
+  const auto dom_status = easy_serialize::from_json_string(expected, dom_route);
+  Route streaming_route;
+  const auto streaming_status = easy_serialize::from_json_string_streaming(expected, streaming_route);
+  if (dom_status.get_error_message() != expected_error || streaming_status.get_error_message() != expected_error)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, expected: '" << expected_error << "', actual: '"
+              << dom_status.get_error_message() << "', '" << streaming_status.get_error_message() << "'\n";
+  }
+  return num_fails;
+}
+#else
+int test_read_string_view()
+{
+  return 0;
+}
+#endif
+
+class Quote
+{
+public:
+  std::string symbol;
+  std::vector<int32_t> sizes;
+  std::vector<bool> flags;
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.ez("symbol", symbol);
+    ar.ez_vector("sizes", sizes);
+    ar.ez_vector("flags", flags);
+  }
+};
+
+int test_read_reuse_vector_elements()
+{
+  int num_fails = 0;
+  easy_serialize::JsonReaderContext context;
+  context.set_reuse_vector_elements(true);
+  std::vector<Quote> quotes;
+  const char *previous_symbol = nullptr;
+  for (size_t num_quotes : {3, 3, 1, 4})
+  {
+    std::vector<Quote> expected(num_quotes);
+    for (size_t i = 0; i < num_quotes; ++i)
+    {
+      expected[i].symbol = "a symbol long enough to be on the heap " + std::to_string(i);
+      expected[i].sizes.assign(i + 1, static_cast<int32_t>(num_quotes));
+      expected[i].flags.assign(num_quotes, i % 2 == 0);
+    }
+    const std::string json = easy_serialize::to_json_string_vector_objects(expected);
+    const auto status = easy_serialize::from_json_string_vector_objects(json, quotes, context);
+    const auto actual = easy_serialize::to_json_string_vector_objects(quotes);
+    if (!status || json != actual)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << status.get_error_message()
+                << "\"\nexpected: " << json << "\nactual: " << actual << "\n";
+    }
+    // The first element's string is overwritten in place.
+    if (previous_symbol && quotes[0].symbol.data() != previous_symbol)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, element not reused\n";
+    }
+    previous_symbol = quotes[0].symbol.data();
+  }
+  return num_fails;
+}
+
+template <typename T>
+struct NumericArray
+{
+  std::vector<T> k;
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.ez_vector("k", k);
+  }
+};
+
+// Reads a numeric array with the readers that scan numbers from the bytes and compares with the
+// DOM reader reading it as an object member, which doesn't.
+template <typename T>
+int check_numeric_array(int line, const std::string &array, const std::string &expected_error)
+{
+  int num_fails = 0;
+  const std::string member_json = "{\"k\": " + array + "}";
+  NumericArray<T> reference;
+  const auto reference_status = easy_serialize::from_json_string(member_json, reference);
+  NumericArray<T> member_streaming;
+  const auto member_streaming_status = easy_serialize::from_json_string_streaming(member_json, member_streaming);
+  std::vector<T> top_level;
+  const auto top_level_status = easy_serialize::from_json_string_vector(array, top_level);
+  std::vector<T> top_level_streaming;
+  const auto top_level_streaming_status = easy_serialize::from_json_string_vector_streaming(array, top_level_streaming);
+
+  const auto same = [&](const std::vector<T> &v)
+  {
+    return v.size() == reference.k.size() &&
+           (v.empty() || std::memcmp(v.data(), reference.k.data(), v.size() * sizeof(T)) == 0);
+  };
+  if (top_level_status.get_error_message() != expected_error ||
+      top_level_streaming_status.get_error_message() != expected_error ||
+      member_streaming_status.get_error_message() != reference_status.get_error_message() ||
+      (expected_error.empty() && (!reference_status || !same(top_level) || !same(top_level_streaming) ||
+                                  !same(member_streaming.k))))
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << line << ", FAIL, array: '" << array << "', expected: '" << expected_error
+              << "', actual: '" << top_level_status.get_error_message() << "', '"
+              << top_level_streaming_status.get_error_message() << "', reference: '"
+              << reference_status.get_error_message() << "', '" << member_streaming_status.get_error_message()
+              << "'\n";
+  }
+  return num_fails;
+}
+
+int test_read_numeric_arrays()
+{
+  int num_fails = 0;
+  num_fails += check_numeric_array<double>(__LINE__, "[]", "");
+  num_fails += check_numeric_array<double>(__LINE__, " [ 1.5 , -0.0,0.1,\n\t123456789.123, 1e22, 1E-22, 2.5e+3 ] ", "");
+  // Beyond the fast conversion, left to rapidjson.
+  num_fails += check_numeric_array<double>(
+      __LINE__, "[0.30000000000000004, 1.7976931348623157e308, 5e-324, 12345678901234567890.5, 1e23]", "");
+  num_fails += check_numeric_array<double>(__LINE__, "[1.5, NaN, -Infinity, 2.5]", "");
+  num_fails += check_numeric_array<double>(__LINE__, "[0.000000000000000000000123456789, 98765.4321e-3]", "");
+  num_fails += check_numeric_array<double>(__LINE__, "[1.5, 2]", "[1] expected a double");
+  num_fails += check_numeric_array<double>(__LINE__, "[1.5, \"2.5\"]", "[1] expected a double");
+  num_fails += check_numeric_array<double>(__LINE__, "[1.5,]", "Invalid value.");
+  num_fails += check_numeric_array<double>(__LINE__, "[1.5 2.5]", "Missing a comma or ']' after an array element.");
+  num_fails += check_numeric_array<double>(__LINE__, "[1.5, 01.5]", "Missing a comma or ']' after an array element.");
+  num_fails += check_numeric_array<double>(__LINE__, "[1.5, 2.]", "Missing fraction part in number.");
+  num_fails += check_numeric_array<double>(__LINE__, "[1.5, 2.5", "Missing a comma or ']' after an array element.");
+  num_fails += check_numeric_array<double>(__LINE__, "[1.5] x", "The document root must not be followed by other values.");
+
+  num_fails += check_numeric_array<int32_t>(__LINE__, "[0, -0, 7, -2147483648, 2147483647, 12345678]", "");
+  num_fails += check_numeric_array<int32_t>(__LINE__, "[1, 2147483648]", "[1] expected an int32");
+  num_fails += check_numeric_array<int32_t>(__LINE__, "[1, 1.0]", "[1] expected an int32");
+  num_fails += check_numeric_array<int64_t>(
+      __LINE__, "[-9223372036854775808, 9223372036854775807, 123456789012345678]", "");
+  num_fails += check_numeric_array<int64_t>(__LINE__, "[1, 9223372036854775808]", "[1] expected an int64");
+  num_fails += check_numeric_array<uint64_t>(__LINE__, "[0, -0, 18446744073709551615]", "");
+  num_fails += check_numeric_array<uint64_t>(__LINE__, "[0, -1]", "[1] expected a uint64");
+  num_fails += check_numeric_array<int8_t>(__LINE__, "[-128, 127]", "");
+  num_fails += check_numeric_array<int8_t>(__LINE__, "[-128, 128]", "[1] expected an int8");
+  num_fails += check_numeric_array<uint8_t>(__LINE__, "[0, 255]", "");
+  num_fails += check_numeric_array<uint8_t>(__LINE__, "[0, 256]", "[1] expected a uint8");
+  num_fails += check_numeric_array<uint16_t>(__LINE__, "[65535, -1]", "[1] expected a uint16");
+  return num_fails;
+}
+
+// Reads JSON Lines and records one "line: d d2" or "line: error" entry per line read.
+class JsonLinesLog
+{
+public:
+  std::vector<std::string> entries;
+  size_t stop_after = 0;
+
+  bool operator()(size_t line_number, const easy_serialize::EasySerializeStatus &status, Y &y)
+  {
+    if (status)
+    {
+      entries.push_back(std::to_string(line_number) + ": " + std::to_string(y.d) + " " + std::to_string(y.d2));
+    }
+    else
+    {
+      entries.push_back(std::to_string(line_number) + ":" + status.get_error_message());
+    }
+    return entries.size() != stop_after;
+  }
+};
+int test_read_json_lines()
+{
+  int num_fails = 0;
+  const std::string json = "{\"d\": 1.5, \"d2\": 2.5}\n"
+                           "\n"
+                           "{\"d\": 3.5, \"d2\": \"x\"}\r\n"
+                           "{\"d\": 4.5\n"
+                           "  \t\n"
+                           "{\"d\": 5.5, \"d2\": 6.5}";
+  const std::vector<std::string> expected = {
+      "1: 1.500000 2.500000",
+      "3:[\"d2\"] expected a double",
+      "4:Missing a comma or '}' after an object member.",
+      "6: 5.500000 6.500000",
+  };
+  const std::string filename = "test_json_lines.jsonl";
+  easy_serialize::to_file(filename, json);
+  std::vector<std::vector<std::string>> actuals;
+  JsonLinesLog log;
+  easy_serialize::for_each_json_line<Y>(json, std::ref(log));
+  actuals.push_back(log.entries);
+  // Small chunks split lines across reads and make the buffer grow to fit the longest line.
+  for (const size_t chunk_size : {size_t(1), size_t(7), size_t(64 * 1024)})
+  {
+    JsonLinesLog file_log;
+    const auto status = easy_serialize::for_each_json_line_file<Y>(filename, std::ref(file_log), chunk_size);
+    if (!status)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, file read error: \"" << status.get_error_message()
+                << "\"\n";
+    }
+    actuals.push_back(file_log.entries);
+  }
+  for (const auto &actual : actuals)
+  {
+    if (actual != expected)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, actual:\n";
+      for (const auto &entry : actual)
+      {
+        std::cerr << "  " << entry << "\n";
+      }
+    }
+  }
+
+  // The callback can stop the reading.
+  JsonLinesLog stopped;
+  stopped.stop_after = 2;
+  easy_serialize::for_each_json_line_file<Y>(filename, std::ref(stopped));
+  if (stopped.entries.size() != 2)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, read " << stopped.entries.size()
+              << " lines after asking to stop after 2\n";
+  }
+  std::remove(filename.c_str());
+
+  const auto missing_status = easy_serialize::for_each_json_line_file<Y>("no_such_file.jsonl", std::ref(log));
+  if (missing_status || missing_status.get_error_message() != "File opening failed.")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, expected a file opening error\n";
+  }
+
+  // Each line reads as it would into a new object, whatever object versions the lines before had,
+  // and a line that fails gives a default constructed object.
+  const std::vector<std::string> versioned_lines = {
+      R"({"b": true, "i": 5, "_objver": 1})", R"({"b": false})", R"({"b": true, "i": "x", "_objver": 1})",
+      R"({"b": true})", R"({"i": 7, "b": true, "_objver": 1})"};
+  std::string versioned_json;
+  std::vector<std::pair<bool, int32_t>> versioned_expected;
+  for (const auto &line : versioned_lines)
+  {
+    versioned_json += line + "\n";
+    TestVersionedObject obj{false, 0};
+    if (!easy_serialize::from_json_string(line, obj))
+    {
+      obj = TestVersionedObject{false, 0};
+    }
+    versioned_expected.emplace_back(obj.b, obj.i);
+  }
+  std::vector<std::pair<bool, int32_t>> versioned_actual;
+  easy_serialize::for_each_json_line<TestVersionedObject>(
+      versioned_json, [&versioned_actual](size_t, const easy_serialize::EasySerializeStatus &, TestVersionedObject &obj)
+      {
+        versioned_actual.emplace_back(obj.b, obj.i);
+        return true; });
+  std::vector<std::pair<double, double>> y_actual;
+  easy_serialize::for_each_json_line<Y>(
+      json, [&y_actual](size_t, const easy_serialize::EasySerializeStatus &, Y &y)
+      {
+        y_actual.emplace_back(y.d, y.d2);
+        return true; });
+  const std::vector<std::pair<double, double>> y_expected = {{1.5, 2.5}, {0.0, 0.0}, {0.0, 0.0}, {5.5, 6.5}};
+  if (versioned_actual != versioned_expected || y_actual != y_expected)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << versioned_actual.size() << " versioned lines, "
+              << y_actual.size() << " lines\n";
+  }
+  return num_fails;
+}
+
+int test_read_json_lines_parallel()
+{
+  int num_fails = 0;
+  // Big enough to be split into several blocks, with blank lines and some lines that fail.
+  std::string json;
+  for (int i = 0; i < 100000; ++i)
+  {
+    if (i % 1000 == 999)
+    {
+      json += "\n";
+    }
+    else if (i % 25000 == 24000)
+    {
+      json += "{\"d\": " + std::to_string(i) + ".5, \"d2\": null}\n";
+    }
+    else
+    {
+      json += "{\"d\": " + std::to_string(i) + ".5, \"d2\": 0.25}\n";
+    }
+  }
+  JsonLinesLog expected;
+  easy_serialize::for_each_json_line<Y>(json, std::ref(expected));
+  const std::string filename = "test_json_lines_parallel.jsonl";
+  easy_serialize::to_file(filename, json);
+  for (const unsigned num_threads : {1u, 3u, 0u})
+  {
+    JsonLinesLog log;
+    easy_serialize::for_each_json_line_parallel<Y>(json, std::ref(log), num_threads);
+    JsonLinesLog file_log;
+    const auto status = easy_serialize::for_each_json_line_file_parallel<Y>(filename, std::ref(file_log), num_threads);
+    if (!status || log.entries != expected.entries || file_log.entries != expected.entries)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << num_threads << " threads, "
+                << log.entries.size() << " and " << file_log.entries.size() << " lines read, expected "
+                << expected.entries.size() << "\n";
+    }
+  }
+
+  // The callback can stop the reading.
+  JsonLinesLog stopped;
+  stopped.stop_after = 50000;
+  easy_serialize::for_each_json_line_parallel<Y>(json, std::ref(stopped));
+  if (stopped.entries.size() != 50000)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, read " << stopped.entries.size()
+              << " lines after asking to stop after 50000\n";
+  }
+
+  // Reading into a vector stops at the first failing line.
+  std::vector<Y> v;
+  const std::string expected_error = "line 24001: [\"d2\"] expected a double";
+  const easy_serialize::EasySerializeStatus statuses[] = {
+      easy_serialize::from_json_lines_string_parallel(json, v),
+      easy_serialize::from_json_lines_file_parallel(filename, v),
+  };
+  for (const auto &status : statuses)
+  {
+    if (status || status.get_error_message() != expected_error)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, expected: '" << expected_error << "', actual: '"
+                << status.get_error_message() << "'\n";
+    }
+  }
+  // Objects of lines with different object versions are the same as read on one thread.
+  std::string versioned_json;
+  for (int i = 0; i < 200000; ++i)
+  {
+    versioned_json += i % 3 == 0 ? "{\"b\": true}\n"
+                                 : "{\"b\": false, \"i\": " + std::to_string(i) + ", \"_objver\": 1}\n";
+  }
+  std::vector<std::string> versioned_expected;
+  const auto log_versioned = [](std::vector<std::string> &entries)
+  {
+    return [&entries](size_t line_number, const easy_serialize::EasySerializeStatus &, TestVersionedObject &obj)
+    {
+      entries.push_back(std::to_string(line_number) + ": " + std::to_string(obj.b) + " " + std::to_string(obj.i));
+      return true;
+    };
+  };
+  easy_serialize::for_each_json_line<TestVersionedObject>(versioned_json, log_versioned(versioned_expected));
+  std::vector<std::string> versioned_actual;
+  easy_serialize::for_each_json_line_parallel<TestVersionedObject>(versioned_json, log_versioned(versioned_actual), 3);
+  std::vector<TestVersionedObject> versioned_v;
+  const auto versioned_status = easy_serialize::from_json_lines_string_parallel(versioned_json, versioned_v, 3);
+  if (versioned_actual != versioned_expected || !versioned_status || versioned_v.size() != 200000 ||
+      versioned_v[3].i != 0 || versioned_v[4].i != 4)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << versioned_actual.size() << " lines read, expected "
+              << versioned_expected.size() << ", error: \"" << versioned_status.get_error_message() << "\"\n";
+  }
+
+  const std::string valid = "{\"d\": 1.5, \"d2\": 2.5}\n\n{\"d\": 3.5, \"d2\": 4.5}";
+  const auto status = easy_serialize::from_json_lines_string_parallel(valid, v, 2);
+  if (!status || v.size() != 2 || v[0].d != 1.5 || v[1].d2 != 4.5)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: \"" << status.get_error_message() << "\"\n";
+  }
+  std::remove(filename.c_str());
+  return num_fails;
+}
+
+int test_read_vector_objects_parallel()
+{
+  int num_fails = 0;
+  std::string big = "[";
+  for (int i = 0; i < 10000; ++i)
+  {
+    big += (i == 0 ? "{\"d\": " : ",{\"d\": ") + std::to_string(i) + ".5, \"d2\": " + std::to_string(i % 7) +
+           ".25}";
+  }
+  big += "]";
+  std::string two_errors = big;
+  two_errors.replace(two_errors.find("\"d2\": 3.25}", two_errors.find("{\"d\": 7000.5")), 11, "\"d2\": \"x\"}");
+  two_errors.replace(two_errors.find("\"d2\": 4.25}", two_errors.find("{\"d\": 3000.5")), 11, "\"d2\": true}");
+  std::string parse_error_after_binding_error = two_errors;
+  parse_error_after_binding_error.replace(parse_error_after_binding_error.find("{\"d\": 9000.5"), 1, "{,");
+  const std::string cases[] = {
+      big,
+      two_errors,
+      parse_error_after_binding_error,
+      "[]",
+      " [ {\"d\": 1.5, \"d2\": 2.5} ] ",
+      "[{\"d\": \"a,]}\\\"\", \"d2\": 2.5}]",
+      "[{\"d\": 1.5, \"d2\": 2.5}, 7]",
+      "[{\"d\": 1.5, \"d2\": 2.5},]",
+      "[{\"d\": 1.5, \"d2\": 2.5}] x",
+      "[{\"d\": 1.5, \"d2\": 2.5}",
+      "{\"d\": 1.5, \"d2\": 2.5}",
+  };
+  for (const auto &json : cases)
+  {
+    std::vector<Y> expected;
+    const auto expected_status = easy_serialize::from_json_string_vector_objects(json, expected);
+    for (const unsigned num_threads : {1u, 4u, 0u})
+    {
+      std::vector<Y> actual;
+      const auto status = easy_serialize::from_json_string_vector_objects_parallel(json, actual, num_threads);
+      if (bool(status) != bool(expected_status) ||
+          status.get_error_message() != expected_status.get_error_message() ||
+          (status && easy_serialize::to_json_string_vector_objects(actual) !=
+                         easy_serialize::to_json_string_vector_objects(expected)))
+      {
+        ++num_fails;
+        std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << num_threads << " threads, json: "
+                  << json.substr(0, 60) << "\nexpected: '" << expected_status.get_error_message() << "', actual: '"
+                  << status.get_error_message() << "'\n";
+      }
+    }
+  }
+  return num_fails;
+}
+
+int test_read_file_contents()
+{
+  int num_fails = 0;
+  const std::string filename = "test_file_contents.json";
+  easy_serialize::to_file(filename, "");
+  Y y;
+  const auto empty_status = easy_serialize::from_json_file(filename, y);
+  if (empty_status || empty_status.get_error_message() != "The document is empty.")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, actual: '" << empty_status.get_error_message() << "'\n";
+  }
+  std::remove(filename.c_str());
+  const auto missing_status = easy_serialize::from_json_file("no_such_file.json", y);
+  if (missing_status || missing_status.get_error_message() != "File opening failed.")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, actual: '" << missing_status.get_error_message() << "'\n";
+  }
+#if EASY_SERIALIZE_HAS_MMAP
+  // A pipe can't be mapped, so it's read instead, in as many reads as it takes.
+  const std::string fifo_name = "test_file_contents.fifo";
+  if (mkfifo(fifo_name.c_str(), 0600) != 0)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, mkfifo failed\n";
+    return num_fails;
+  }
+  std::string json = "[";
+  for (int i = 0; i < 100000; ++i)
+  {
+    json += (i == 0 ? "" : ",") + std::to_string(i);
+  }
+  json += "]";
+  std::thread writer([&]()
+                     { easy_serialize::to_file(fifo_name, json); });
+  std::vector<int32_t> v;
+  const auto status = easy_serialize::from_json_file_vector(fifo_name, v);
+  writer.join();
+  std::remove(fifo_name.c_str());
+  if (!status || v.size() != 100000 || v.back() != 99999)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << status.get_error_message() << "', "
+              << v.size() << " values read\n";
+  }
+#endif
+  return num_fails;
+}
+
+int test_read_file_streaming()
+{
+  int num_fails = 0;
+  const std::string filename = "test_file_streaming.json";
+  const std::string cases[] = {
+      "[{\"d\": 1.5, \"d2\": 2.5}, {\"d\": 3.5, \"d2\": 4.5}, {\"d\": 5.5, \"d2\": 6.5}]",
+      "\xEF\xBB\xBF[{\"d\": 1.5, \"d2\": 2.5}]",
+      "[{\"d\": 1.5, \"d2\": 2.5}, {\"d\": 3.5, \"d2\": false}, {\"d\": 5.5, \"d2\": 6.5}]",
+      "[{\"d\": 1.5, \"d2\": 2.5}, {\"d\": 3.5, \"d2\": false}, {\"d\": 5.5, \"d2\": 6.5}",
+      "{\"d\": 1.5, \"d2\": 2.5}",
+      "",
+  };
+  for (const auto &json : cases)
+  {
+    easy_serialize::to_file(filename, json);
+    std::vector<Y> expected;
+    const auto expected_status = easy_serialize::from_json_file_vector_objects(filename, expected);
+    std::vector<Y> actual;
+    const auto status = easy_serialize::from_json_file_vector_objects_streaming(filename, actual);
+    std::vector<Y> each;
+    const auto each_status = easy_serialize::for_each_json_file_object<Y>(filename, [&each](size_t index, Y &y)
+                                                                          {
+                                                                            if (index == each.size())
+                                                                            {
+                                                                              each.push_back(y);
+                                                                            }
+                                                                            return true; });
+    for (const auto &s : {status, each_status})
+    {
+      if (bool(s) != bool(expected_status) || s.get_error_message() != expected_status.get_error_message())
+      {
+        ++num_fails;
+        std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, json: " << json << "\nexpected: '"
+                  << expected_status.get_error_message() << "', actual: '" << s.get_error_message() << "'\n";
+      }
+    }
+    if (expected_status && (easy_serialize::to_json_string_vector_objects(actual) !=
+                                easy_serialize::to_json_string_vector_objects(expected) ||
+                            easy_serialize::to_json_string_vector_objects(each) !=
+                                easy_serialize::to_json_string_vector_objects(expected)))
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, json: " << json << "\n";
+    }
+  }
+
+  // The callback can stop the reading, before the error in the file.
+  easy_serialize::to_file(filename, cases[2]);
+  size_t num_read = 0;
+  const auto stopped_status = easy_serialize::for_each_json_file_object<Y>(filename, [&num_read](size_t, Y &)
+                                                                           { return ++num_read < 1; });
+  if (!stopped_status || num_read != 1)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << stopped_status.get_error_message() << "', "
+              << num_read << " objects read\n";
+  }
+
+  // The other kinds of value.
+  Y y;
+  y.d = 1.25;
+  y.d2 = -2.5;
+  easy_serialize::to_json_file(filename, y);
+  Y y2;
+  const auto object_status = easy_serialize::from_json_file_streaming(filename, y2);
+  std::vector<double> doubles = {1.5, 2.5, 3.5};
+  easy_serialize::to_json_file_vector(filename, doubles);
+  std::vector<double> doubles2;
+  const auto vector_status = easy_serialize::from_json_file_vector_streaming(filename, doubles2);
+  std::vector<OrangeJuicePulpLevel> levels = {OrangeJuicePulpLevel::High, OrangeJuicePulpLevel::Low};
+  easy_serialize::to_json_file_vector_enums(filename, levels);
+  std::vector<OrangeJuicePulpLevel> levels2;
+  const auto enums_status = easy_serialize::from_json_file_vector_enums_streaming(filename, levels2,
+                                                                                   OrangeJuicePulpLevel::N);
+  if (!object_status || !vector_status || !enums_status || y2.d != y.d || y2.d2 != y.d2 || doubles2 != doubles ||
+      levels2 != levels)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, errors: '" << object_status.get_error_message() << "', '"
+              << vector_status.get_error_message() << "', '" << enums_status.get_error_message() << "'\n";
+  }
+  std::remove(filename.c_str());
+
+  const auto missing_status = easy_serialize::from_json_file_streaming("no_such_file.json", y);
+  if (missing_status || missing_status.get_error_message() != "File opening failed.")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, actual: '" << missing_status.get_error_message() << "'\n";
+  }
+  return num_fails;
+}
+
+// A few members of Z, in a different order.
+class ZProjection
+{
+public:
+  std::vector<Y> v_y;
+  int32_t i32 = 0;
+  Y y;
+  std::vector<std::string> v_s;
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.ez_vector_objects("v_y", v_y);
+    ar.ez("i32", i32);
+    ar.ez_object("y", y);
+    ar.ez_vector("v_s", v_s);
+  }
+};
+// Asks for "x" only once "kind" has been read as "point", so "x" isn't asked for on a default object.
+class Shape
+{
+public:
+  std::string kind;
+  double x = 0.0;
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.ez("kind", kind);
+    if (kind == "point")
+    {
+      ar.ez("x", x);
+    }
+  }
+};
+int test_read_projection()
+{
+  int num_fails = 0;
+  const std::string json = R"zzz({
+  "i8": 127,
+  "i32": 42,
+  "s": "}]\"{[,",
+  "nested": {"a": [1, {"b": "]"}], "c": {}},
+  "y": {"d": 1.0, "unused": [[], {}], "d2": 2.0},
+  "v_y": [{"d": 3.0, "d2": 4.0, "x": null}, {"x": "\\", "d": 5.0, "d2": 6.0}],
+  "d": -1.5e-3,
+  "v_s": ["we", "are", "strings"],
+  "b": true
+})zzz";
+  ZProjection expected;
+  const auto expected_status = easy_serialize::from_json_string(json, expected);
+  ZProjection actual;
+  const auto status = easy_serialize::from_json_string_projection(json, actual);
+  if (!expected_status || !status ||
+      easy_serialize::to_json_string(actual) != easy_serialize::to_json_string(expected))
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, errors: '" << expected_status.get_error_message()
+              << "', '" << status.get_error_message() << "'\nexpected: " << easy_serialize::to_json_string(expected)
+              << "\nactual: " << easy_serialize::to_json_string(actual) << "\n";
+  }
+
+  std::vector<ZProjection> v;
+  const auto vector_status =
+      easy_serialize::from_json_string_vector_objects_projection("[" + json + "," + json + "]", v);
+  if (!vector_status || v.size() != 2 || v[1].v_s != expected.v_s || v[1].y.d2 != 2.0)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << vector_status.get_error_message() << "'\n";
+  }
+
+  // Errors in the members read are the same as without projection.
+  const std::string bad_value = "{\"i32\": 42, \"v_y\": [{\"d\": 1.0, \"d2\": \"x\"}], \"y\": {}, \"v_s\": []}";
+  const std::string malformed = "{\"v_y\": [], \"skipped\": 1, \"i32\": 42, \"y\": {\"d\": 1.0 \"d2\": 2.0}, \"v_s\": []}";
+  for (const auto &case_json : {bad_value, malformed})
+  {
+    ZProjection z;
+    const auto case_expected_status = easy_serialize::from_json_string_streaming(case_json, z);
+    const auto case_status = easy_serialize::from_json_string_projection(case_json, z);
+    if (case_status || case_status.get_error_message() != case_expected_status.get_error_message())
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, expected: '" << case_expected_status.get_error_message()
+                << "', actual: '" << case_status.get_error_message() << "'\n";
+    }
+  }
+
+  // Skipped members aren't validated.
+  ZProjection z;
+  const auto unvalidated_status = easy_serialize::from_json_string_projection(
+      "{\"v_y\": [], \"skipped\": [1 2 tru], \"i32\": 42, \"y\": {\"d\": 1.0, \"d2\": 2.0}, \"v_s\": []}", z);
+  if (!unvalidated_status || z.i32 != 42)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << unvalidated_status.get_error_message() << "'\n";
+  }
+
+  // A member skipped before the member that makes serialize() ask for it is still read, and
+  // reads the same as without projection.
+  const std::vector<TestCase> shape_cases = {
+      {"{\"x\": 2.5, \"kind\": \"point\"}", ""},
+      {"{\"x\": 2.5, \"kind\": \"line\"}", ""},
+      {"{\"x\": [2.5], \"x\": 2.5, \"kind\": \"point\"}", "[\"x\"] expected a double"},
+      {"{\"kind\": \"point\"}", "[\"x\"] key not found"},
+  };
+  for (const auto &tc : shape_cases)
+  {
+    Shape expected_shape;
+    const auto shape_expected_status = easy_serialize::from_json_string_streaming(tc.json, expected_shape);
+    Shape shape;
+    const auto shape_status = easy_serialize::from_json_string_projection(tc.json, shape);
+    if (shape_status.get_error_message() != tc.expected_error ||
+        shape_expected_status.get_error_message() != tc.expected_error || shape.x != expected_shape.x)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << tc.json << ", expected: '" << tc.expected_error
+                << "' " << expected_shape.x << ", actual: '" << shape_status.get_error_message() << "' " << shape.x
+                << "\n";
+    }
+  }
+  return num_fails;
+}
+
+class Envelope
+{
+public:
+  int32_t id = 0;
+  easy_serialize::Lazy<Y> y;
+  easy_serialize::Lazy<std::vector<Y>> v_y;
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.ez("id", id);
+    ar.ez("y", y);
+    ar.ez("v_y", v_y);
+  }
+};
+int test_read_lazy()
+{
+  int num_fails = 0;
+  const std::string json = R"zzz({
+  "id": 7,
+  "y": { "d": 1.5, "d2": -2.0, "extra": "}" },
+  "v_y": [{"d": 3.0, "d2": 4.0}, {"d": 5.0, "d2": 6.0}]
+})zzz";
+  using Read = std::function<easy_serialize::EasySerializeStatus(const std::string &, Envelope &)>;
+  const std::vector<std::pair<const char *, Read>> readers = {
+      {"dom", [](const std::string &j, Envelope &e)
+       { return easy_serialize::from_json_string(j, e); }},
+      {"streaming", [](const std::string &j, Envelope &e)
+       { return easy_serialize::from_json_string_streaming(j, e); }},
+      {"projection", [](const std::string &j, Envelope &e)
+       { return easy_serialize::from_json_string_projection(j, e); }},
+  };
+  // The streaming readers keep the bytes as they are, the document reader writes them compactly.
+  const std::vector<std::string> expected_y_raw = {
+      "{\"d\":1.5,\"d2\":-2.0,\"extra\":\"}\"}", "{ \"d\": 1.5, \"d2\": -2.0, \"extra\": \"}\" }",
+      "{ \"d\": 1.5, \"d2\": -2.0, \"extra\": \"}\" }"};
+  for (size_t i = 0; i < readers.size(); ++i)
+  {
+    Envelope e;
+    const auto status = readers[i].second(json, e);
+    if (!status || e.id != 7 || e.y.is_decoded() || e.v_y.is_decoded() || e.y.raw() != expected_y_raw[i])
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << readers[i].first << ", error: '"
+                << status.get_error_message() << "', y: '" << e.y.raw() << "'\n";
+      continue;
+    }
+    // Undecoded members are written out as they were read.
+    const std::string written = easy_serialize::to_json_string(e);
+    if (written.find(e.y.raw()) == std::string::npos || written.find(e.v_y.raw()) == std::string::npos)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << readers[i].first << ", actual: '" << written
+                << "'\n";
+    }
+    // Decoded on first use, then written from the objects.
+    const auto decode_status = e.v_y.decode();
+    e.y.get().d = 10.0;
+    Envelope reread;
+    const auto reread_status = easy_serialize::from_json_string(easy_serialize::to_json_string(e), reread);
+    if (!decode_status || !e.y.is_decoded() || e.v_y.get().size() != 2 || e.v_y.get()[1].d2 != 6.0 ||
+        !reread_status || reread.y.get().d != 10.0 || reread.y.get().d2 != -2.0 || reread.v_y.get().size() != 2 ||
+        reread.v_y.get()[1].d != 5.0)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << readers[i].first << ", errors: '"
+                << decode_status.get_error_message() << "', '" << reread_status.get_error_message() << "'\n";
+    }
+  }
+
+  // A member read ahead of the ones asked for has been parsed, so it's kept compactly.
+  Envelope ahead;
+  const auto ahead_status = easy_serialize::from_json_string_streaming(
+      R"({"y": { "d": 1.5, "d2": -2.0 }, "id": 7, "v_y": [ ]})", ahead);
+  if (!ahead_status || ahead.id != 7 || ahead.y.raw() != "{\"d\":1.5,\"d2\":-2.0}" || ahead.v_y.raw() != "[ ]")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << ahead_status.get_error_message()
+              << "', y: '" << ahead.y.raw() << "', v_y: '" << ahead.v_y.raw() << "'\n";
+  }
+
+  // Only the shape is checked when reading, the contents when decoding.
+  const std::string bad_shape = R"({"id": 7, "y": [], "v_y": []})";
+  const std::string bad_contents = R"({"id": 7, "y": {"d": "x", "d2": 1.0}, "v_y": []})";
+  for (size_t i = 0; i < readers.size(); ++i)
+  {
+    Envelope e;
+    const auto shape_status = readers[i].second(bad_shape, e);
+    if (shape_status || shape_status.get_error_message() != "[\"y\"] expected an object")
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << readers[i].first << ", error: '"
+                << shape_status.get_error_message() << "'\n";
+    }
+    const auto status = readers[i].second(bad_contents, e);
+    const auto decode_status = e.y.decode();
+    if (!status || decode_status || decode_status.get_error_message() != "[\"d\"] expected a double" ||
+        e.y.is_decoded() || e.y.decode().get_error_message() != decode_status.get_error_message())
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << readers[i].first << ", errors: '"
+                << status.get_error_message() << "', '" << decode_status.get_error_message() << "'\n";
+    }
+  }
+  return num_fails;
+}
+
+// The native writer writes the same bytes as the rapidjson one.
+int test_writer_native()
+{
+  int num_fails = 0;
+  using Write = std::function<void(std::string &, easy_serialize::JsonIndent)>;
+  const auto check = [&num_fails](const char *name, Write rapidjson_write, Write native_write)
+  {
+    for (const auto indent : {easy_serialize::JsonIndent::compact, easy_serialize::JsonIndent::one_space,
+                              easy_serialize::JsonIndent::four_spaces})
+    {
+      std::string expected;
+      std::string actual = "prefix ";
+      rapidjson_write(expected, indent);
+      native_write(actual, indent);
+      if ("prefix " + expected != actual)
+      {
+        ++num_fails;
+        std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << name << ", expected: " << expected
+                  << "\nactual: " << actual << "\n";
+      }
+    }
+  };
+  const auto check_object = [&check](const char *name, auto &obj)
+  {
+    check(
+        name, [&obj](std::string &json, easy_serialize::JsonIndent indent)
+        {
+          easy_serialize::StringOutputStream os(json);
+          easy_serialize::to_json_stream(os, obj, indent); },
+        [&obj](std::string &json, easy_serialize::JsonIndent indent)
+        { easy_serialize::native_impl::to_json_string(obj, json, indent); });
+  };
+
+  Z z;
+  z.i8 = std::numeric_limits<int8_t>::min();
+  z.i64 = std::numeric_limits<int64_t>::min();
+  z.u64 = std::numeric_limits<uint64_t>::max();
+  z.d = 1e-7;
+  const char s[] = "tab\t, quote\", backslash\\, control\x01\x1f, slash /, utf-8 \xc3\xa9, null \0 cut";
+  z.s = std::string(s, sizeof(s) - 1);
+  z.pulp_level = OrangeJuicePulpLevel::N;
+  z.y.d = std::numeric_limits<double>::quiet_NaN();
+  z.y.d2 = -std::numeric_limits<double>::infinity();
+  z.v_y = {{0.0, std::numeric_limits<double>::infinity()}, {}};
+  z.v_e = {OrangeJuicePulpLevel::High, OrangeJuicePulpLevel::N};
+  z.v_s = {"", "\b\f\n\r"};
+  check_object("z", z);
+  Z empty;
+  check_object("empty vectors", empty);
+  EscapedKeys keys;
+  check_object("keys", keys);
+  TestVersionedObject versioned{true, 2};
+  check_object("versioned", versioned);
+
+  Envelope e;
+  const auto status = easy_serialize::from_json_string_projection(
+      R"zzz({"id": 7, "y": { "d": 1.5, "d2": -2.0 }, "v_y": [{"d": 3.0, "d2": 4.0}]})zzz", e);
+  if (!status)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << status.get_error_message() << "'\n";
+  }
+  check_object("lazy", e);
+  e.v_y.get().push_back({5.0, 6.0});
+  check_object("decoded", e);
+
+  check(
+      "vector objects", [&z](std::string &json, easy_serialize::JsonIndent indent)
+      {
+        easy_serialize::StringOutputStream os(json);
+        easy_serialize::to_json_stream_vector_objects(os, z.v_y, indent); },
+      [&z](std::string &json, easy_serialize::JsonIndent indent)
+      { easy_serialize::native_impl::to_json_string_vector_objects(z.v_y, json, indent); });
+  check(
+      "vector", [&z](std::string &json, easy_serialize::JsonIndent indent)
+      {
+        easy_serialize::StringOutputStream os(json);
+        easy_serialize::to_json_stream_vector(os, z.v_s, indent); },
+      [&z](std::string &json, easy_serialize::JsonIndent indent)
+      { easy_serialize::native_impl::to_json_string_vector(z.v_s, json, indent); });
+  check(
+      "vector enums", [&z](std::string &json, easy_serialize::JsonIndent indent)
+      {
+        easy_serialize::StringOutputStream os(json);
+        easy_serialize::to_json_stream_vector_enums(os, z.v_e, indent); },
+      [&z](std::string &json, easy_serialize::JsonIndent indent)
+      { easy_serialize::native_impl::to_json_string_vector_enums(z.v_e, json, indent); });
+  check(
+      "vector enums names", [&z](std::string &json, easy_serialize::JsonIndent indent)
+      {
+        easy_serialize::StringOutputStream os(json);
+        easy_serialize::to_json_stream_vector_enums(os, z.v_e, OrangeJuicePulpLevel::N, indent); },
+      [&z](std::string &json, easy_serialize::JsonIndent indent)
+      { easy_serialize::native_impl::to_json_string_vector_enums(z.v_e, OrangeJuicePulpLevel::N, json, indent); });
+  std::vector<Y> no_objects;
+  check(
+      "empty vector", [&no_objects](std::string &json, easy_serialize::JsonIndent indent)
+      {
+        easy_serialize::StringOutputStream os(json);
+        easy_serialize::to_json_stream_vector_objects(os, no_objects, indent); },
+      [&no_objects](std::string &json, easy_serialize::JsonIndent indent)
+      { easy_serialize::native_impl::to_json_string_vector_objects(no_objects, json, indent); });
+  return num_fails;
+}
+
+// Keys are worked out at compile time from string literals.
+static_assert(easy_serialize::JsonKey("i32").length == 3, "key length");
+static_assert(easy_serialize::JsonKey("i32").hash == easy_serialize::hash_key("i32", 3), "key hash");
+
+class WideKeys
+{
+public:
+  std::vector<int32_t> values = std::vector<int32_t>(20);
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    char key[16] = "v";
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+      std::snprintf(key + 1, sizeof(key) - 1, "%zu", i);
+      // A char array longer than its string, and a const char *.
+      if (i % 2 == 0)
+      {
+        ar.ez(key, values[i]);
+      }
+      else
+      {
+        const char *key_ptr = key;
+        ar.ez(key_ptr, values[i]);
+      }
+    }
+  }
+};
+// Opts in, but binds the elements of a std::vector, so gets no schema.
+namespace easy_serialize
+{
+  template <>
+  struct HasFixedFields<WideKeys> : std::true_type
+  {
+  };
+} // namespace easy_serialize
+// Keys declared as constexpr JsonKeys, as the README suggests to be sure they're worked out at
+// compile time.
+constexpr easy_serialize::JsonKey constexpr_b_key("b");
+constexpr easy_serialize::JsonKey constexpr_i_key("i");
+class ConstexprKeys
+{
+public:
+  bool b = false;
+  int32_t i = 0;
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.ez(constexpr_b_key, b);
+    ar.ez(constexpr_i_key, i);
+  }
+};
+namespace easy_serialize
+{
+  template <>
+  struct HasFixedFields<ConstexprKeys> : std::true_type
+  {
+  };
+} // namespace easy_serialize
+int test_read_keys()
+{
+  int num_fails = 0;
+  // More members than are searched one by one, out of order, with an unknown and a repeated one.
+  std::string json = "{\"unknown\": 0";
+  for (size_t i = 20; i-- > 0;)
+  {
+    json += ", \"v" + std::to_string(i) + "\": " + std::to_string(i * 10);
+  }
+  json += ", \"v3\": -1}";
+  WideKeys expected;
+  for (size_t i = 0; i < expected.values.size(); ++i)
+  {
+    expected.values[i] = static_cast<int32_t>(i * 10);
+  }
+  WideKeys actual;
+  const auto status = easy_serialize::from_json_string(json, actual);
+  WideKeys streamed;
+  const auto streaming_status = easy_serialize::from_json_string_streaming(json, streamed);
+  if (!status || actual.values != expected.values || !streaming_status || streamed.values != expected.values)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, errors: '" << status.get_error_message() << "', '"
+              << streaming_status.get_error_message() << "'\n";
+  }
+
+  const std::string missing = "{\"v0\": 0, \"v1\": 1, \"v2\": 2, \"v3\": 3, \"v4\": 4, \"v5\": 5, \"v6\": 6, "
+                              "\"v7\": 7, \"v8\": 8, \"v10\": 10}";
+  const auto missing_status = easy_serialize::from_json_string(missing, actual);
+  if (missing_status.get_error_message() != "[\"v9\"] key not found")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << missing_status.get_error_message() << "'\n";
+  }
+
+  // Every reader takes constexpr JsonKeys.
+  const std::string constexpr_json = "{\"skipped\": [1], \"i\": 7, \"b\": true}";
+  ConstexprKeys from_dom;
+  const auto dom_status = easy_serialize::from_json_string(constexpr_json, from_dom);
+  ConstexprKeys from_stream;
+  const auto stream_status = easy_serialize::from_json_string_streaming(constexpr_json, from_stream);
+  ConstexprKeys from_projection;
+  const auto projection_status = easy_serialize::from_json_string_projection(constexpr_json, from_projection);
+  if (!dom_status || !stream_status || !projection_status || !from_dom.b || from_dom.i != 7 || !from_stream.b ||
+      from_stream.i != 7 || !from_projection.b || from_projection.i != 7 ||
+      easy_serialize::to_json_string(from_projection) != easy_serialize::to_json_string(from_dom))
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, errors: '" << dom_status.get_error_message() << "', '"
+              << stream_status.get_error_message() << "', '" << projection_status.get_error_message() << "'\n";
+  }
+  return num_fails;
+}
+
+// Reads the members named by its keys.
+class DuplicateKeys
+{
+public:
+  explicit DuplicateKeys(const std::vector<std::string> &keys_) : keys(keys_) {}
+
+  std::vector<std::string> keys;
+  std::vector<int32_t> values;
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    values.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+      ar.ez(keys[i].c_str(), values[i]);
+    }
+  }
+};
+int test_read_duplicate_keys()
+{
+  int num_fails = 0;
+  // The first of repeated members is read, however the reader finds it.
+  struct DuplicateCase
+  {
+    std::string json;
+    std::vector<std::string> keys;
+    std::vector<int32_t> expected;
+  };
+  std::string wide = "{";
+  std::vector<std::string> wide_keys;
+  std::vector<int32_t> wide_expected;
+  for (int32_t i = 0; i < 12; ++i)
+  {
+    wide += "\"k" + std::to_string(i) + "\": " + std::to_string(i) + ", ";
+    wide_keys.push_back("k" + std::to_string(i));
+    wide_expected.push_back(i);
+  }
+  wide += "\"k1\": -1, \"k0\": -1}";
+  std::vector<std::string> wide_reversed_keys(wide_keys.rbegin(), wide_keys.rend());
+  std::vector<int32_t> wide_reversed_expected(wide_expected.rbegin(), wide_expected.rend());
+  const std::vector<DuplicateCase> cases = {
+      {R"({"a": 1, "b": 2, "a": 3, "c": 4})", {"a", "b", "c"}, {1, 2, 4}},
+      {R"({"a": 1, "b": 2, "a": 3, "c": 4})", {"b", "a", "c"}, {2, 1, 4}},
+      {R"({"a": 1, "a": 2, "b": 3})", {"b", "a"}, {3, 1}},
+      {R"({"c": 1, "b": 2, "a": 3, "b": 4, "a": 5})", {"b", "a", "c"}, {2, 3, 1}},
+      {wide, wide_keys, wide_expected},
+      {wide, wide_reversed_keys, wide_reversed_expected},
+  };
+  for (const auto &c : cases)
+  {
+    DuplicateKeys actual(c.keys);
+    const auto status = easy_serialize::from_json_string(c.json, actual);
+    DuplicateKeys streamed(c.keys);
+    const auto streaming_status = easy_serialize::from_json_string_streaming(c.json, streamed);
+    if (!status || actual.values != c.expected || !streaming_status || streamed.values != c.expected)
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, '" << c.json << "', errors: '"
+                << status.get_error_message() << "', '" << streaming_status.get_error_message() << "'\n";
+    }
+  }
+  return num_fails;
+}
+
+// Asks for "x" only for objects of kind 1, so doesn't opt in to a schema.
+class KindDependent
+{
+public:
+  int32_t kind = 0;
+  int32_t x = 0;
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.ez("kind", kind);
+    if (kind == 1)
+    {
+      ar.ez("x", x);
+    }
+  }
+};
+int test_read_schema()
+{
+  int num_fails = 0;
+  // Types that opt in and bind only their own members are read through a schema, others with
+  // serialize().
+  const auto *z_schema = easy_serialize::rapidjson_impl::get_object_schema<Z>();
+  if (!z_schema || z_schema->fields.size() != 16 || z_schema->fields[11].key != "pulp level" ||
+      easy_serialize::rapidjson_impl::get_object_schema<WideKeys>() ||
+      easy_serialize::rapidjson_impl::get_object_schema<KindDependent>())
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL\n";
+  }
+  // Schemas keep the length and hash of constexpr JsonKeys.
+  const auto *constexpr_schema = easy_serialize::rapidjson_impl::get_object_schema<ConstexprKeys>();
+  if (!constexpr_schema || constexpr_schema->fields.size() != 2 || constexpr_schema->fields[1].key != "i" ||
+      constexpr_schema->fields[1].hash != constexpr_i_key.hash)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL\n";
+  }
+
+  // Fields that depend on the object's state are read.
+  std::vector<KindDependent> kinds;
+  const auto kinds_status =
+      easy_serialize::from_json_string_vector_objects(R"([{"kind": 0}, {"kind": 1, "x": 5}])", kinds);
+  if (!kinds_status || kinds.size() != 2 || kinds[1].x != 5)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << kinds_status.get_error_message() << "'\n";
+  }
+
+  // Out of order, repeated and versioned members read the same as with serialize().
+  struct VersionedCase
+  {
+    std::string json;
+    std::string expected_error;
+    bool b;
+    int32_t i;
+  };
+  const std::vector<VersionedCase> cases = {
+      {R"({"i": 2, "b": true, "_objver": 1, "b": false})", "", true, 2},
+      {R"({"i": 2, "b": true})", "", true, 0},
+      {R"({"b": true, "i": "x", "_objver": 1})", "[\"i\"] expected an int32", false, 0},
+      {R"({"i": 2, "_objver": 1})", "[\"b\"] key not found", false, 0},
+  };
+  for (const auto &c : cases)
+  {
+    TestVersionedObject actual{false, 0};
+    const auto status = easy_serialize::from_json_string(c.json, actual);
+    if (status.get_error_message() != c.expected_error || (status && (actual.b != c.b || actual.i != c.i)))
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, '" << c.json << "', expected: '" << c.expected_error
+                << "', actual: '" << status.get_error_message() << "'\n";
+    }
+  }
+
+  // Errors deep in a document are reported as with serialize().
+  std::vector<Z> zs(2);
+  zs[1].v_y.resize(2);
+  std::string json = easy_serialize::to_json_string_vector_objects(zs);
+  json.replace(json.rfind("\"d2\": 0.0"), 9, "\"d2\": true");
+  std::vector<Z> v;
+  const auto v_status = easy_serialize::from_json_string_vector_objects(json, v);
+  if (v_status.get_error_message() != "[1][\"v_y\"][1][\"d2\"] expected a double")
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, error: '" << v_status.get_error_message() << "'\n";
+  }
+  return num_fails;
+}
+
+// Feed json to a JsonPushReader in fragments of random sizes up to max_fragment_size.
+easy_serialize::EasySerializeStatus push_json(const std::string &json, size_t max_fragment_size, Z &z)
+{
+  std::mt19937 rng(static_cast<unsigned>(max_fragment_size));
+  easy_serialize::JsonPushReader<Z> reader(z);
+  std::string fragment;
+  for (size_t pos = 0; pos < json.size();)
+  {
+    const size_t size = std::min<size_t>(1 + rng() % max_fragment_size, json.size() - pos);
+    fragment.assign(json, pos, size);
+    const bool more = reader.feed(fragment.data(), fragment.size());
+    // The reader is done with the fragment.
+    fragment.assign(size, '?');
+    if (!more)
+    {
+      break;
+    }
+    pos += size;
+  }
+  return reader.finish();
+}
+
+// Has a schema the push reader binds a member at a time.
+class PushVersioned
+{
+public:
+  bool b = false;
+  std::string s;
+
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    ar.class_version(1);
+    ar.ez("b", b);
+    ar.ez("s", s);
+  }
+};
+namespace easy_serialize
+{
+  template <>
+  struct HasFixedFields<PushVersioned> : std::true_type
+  {
+  };
+} // namespace easy_serialize
+// The same without a schema, so the push reader builds a DOM.
+class PushUnfixed : public PushVersioned
+{
+};
+
+// Read each of jsons with one JsonPushReader in fragments of 3 bytes, and check that the results
+// and errors are those of the streaming reader.
+template <typename T>
+int push_matches_streaming(const std::vector<std::string> &jsons)
+{
+  int num_fails = 0;
+  T obj;
+  easy_serialize::JsonPushReader<T> reader(obj);
+  for (const auto &json : jsons)
+  {
+    T expected;
+    const auto expected_status = easy_serialize::from_json_string_streaming(json, expected);
+    T actual;
+    reader.reset(actual);
+    for (size_t pos = 0; pos < json.size(); pos += 3)
+    {
+      reader.feed(json.data() + pos, std::min<size_t>(3, json.size() - pos));
+    }
+    const auto status = reader.finish();
+    if (status.get_error_message() != expected_status.get_error_message() ||
+        (status && easy_serialize::to_json_string(actual) != easy_serialize::to_json_string(expected)))
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, '" << json.substr(0, 80) << "', expected: '"
+                << expected_status.get_error_message() << "', actual: '" << status.get_error_message() << "'\n";
+    }
+  }
+  return num_fails;
+}
+
+int test_read_push()
+{
+  int num_fails = 0;
+  const std::string json = "\xEF\xBB\xBF" R"zzz({
+  "i8": 127, "i16": -32768, "i32": 42, "i64": -9, "u8": 255, "u16": 65535, "u32": 196, "u64": 327,
+  "b": true,
+  "d": 0.10000000000000001,
+  "s": "grr \"\u00e9\" \\",
+  "unknown": {"a": [1, 2, {"b": null}]},
+  "pulp level": "medium",
+  "y": {"d": 1.0, "d2": 2.0},
+  "v_y": [{"d2": 4.0, "d": 3.0}, {"d": 5.0, "d2": 6.0, "extra": "x"}],
+  "v_e": ["medium", "high", "low"],
+  "v_s": ["we", "are", "strings"]
+}
+)zzz";
+  Z expected;
+  const auto expected_status = easy_serialize::from_json_string(json, expected);
+  for (const size_t max_fragment_size : {size_t{1}, size_t{2}, size_t{7}, size_t{64}, json.size()})
+  {
+    Z actual;
+    const auto status = push_json(json, max_fragment_size, actual);
+    if (!expected_status || !status ||
+        easy_serialize::to_json_string(actual) != easy_serialize::to_json_string(expected))
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, fragments up to " << max_fragment_size
+                << " bytes, errors: '" << expected_status.get_error_message() << "', '"
+                << status.get_error_message() << "'\n";
+    }
+  }
+
+  // The same errors as the streaming reader.
+  const std::string bad_value = R"({"i8": 1000})";
+  const std::string malformed = R"({"i8": 1, "i16": 2 "i32": 3})";
+  const std::string trailing = R"({"i8": 1} {})";
+  // Errors in later fields, read before a missing or bad earlier one.
+  const std::string bad_later = R"({"i16": "x"})";
+  const std::string bad_earlier = R"({"i16": "x", "i8": 1000})";
+  for (const auto &case_json :
+       {bad_value, malformed, trailing, bad_later, bad_earlier, std::string(" "), std::string()})
+  {
+    Z z;
+    const auto case_expected_status = easy_serialize::from_json_string_streaming(case_json, z);
+    for (const size_t max_fragment_size : {size_t{1}, size_t{5}})
+    {
+      const auto status = push_json(case_json, max_fragment_size, z);
+      if (status || status.get_error_message() != case_expected_status.get_error_message())
+      {
+        ++num_fails;
+        std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, '" << case_json << "', expected: '"
+                  << case_expected_status.get_error_message() << "', actual: '" << status.get_error_message()
+                  << "'\n";
+      }
+    }
+  }
+
+  // feed() says when the rest of malformed JSON needn't be sent.
+  Z z;
+  easy_serialize::JsonPushReader<Z> reader(z);
+  const char good_json[] = "{\"i8\": 1,";
+  const char bad_json[] = "\"i16\": }";
+  const bool good = reader.feed(good_json, sizeof(good_json) - 1);
+  const bool bad = reader.feed(bad_json, sizeof(bad_json) - 1);
+  const auto status = reader.finish();
+  if (!good || bad || status || reader.feed("{}", 2))
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << good << bad << ", error: '"
+              << status.get_error_message() << "'\n";
+  }
+
+  // An object with a schema is bound a member at a time, as the bytes arrive.
+  Y pushed_y;
+  easy_serialize::JsonPushReader<Y> binding_reader(pushed_y);
+  const char first_member[] = "{\"d\": 1.5, \"d2\": ";
+  binding_reader.feed(first_member, sizeof(first_member) - 1);
+  const double d_before_finish = pushed_y.d;
+  binding_reader.feed("2.5}", 4);
+  const auto binding_status = binding_reader.finish();
+  if (d_before_finish != 1.5 || !binding_status || pushed_y.d2 != 2.5)
+  {
+    ++num_fails;
+    std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, d before finish: " << d_before_finish << ", error: '"
+              << binding_status.get_error_message() << "'\n";
+  }
+
+  // Object versions, members bigger than the memory pool, and a root that isn't an object, with
+  // and without a schema.
+  const std::vector<std::string> versioned_jsons = {
+      R"({"_objver": 1, "s": "a", "b": true})",
+      R"({"b": true, "s": "a", "_objver": 2})",
+      R"({"_objver": "x", "b": true})",
+      R"({"s": 1, "_objver": 2})",
+      R"({"s": ")" + std::string(40000, 'x') + R"(", "b": true})",
+      R"({"s": "a"})",
+      R"([1])",
+  };
+  num_fails += push_matches_streaming<PushVersioned>(versioned_jsons);
+  num_fails += push_matches_streaming<PushUnfixed>(versioned_jsons);
+
+  // reset() reads more documents with the same reader, after a good or a bad one.
+  Y y;
+  easy_serialize::JsonPushReader<Y> y_reader(y);
+  for (int i = 0; i < 100; ++i)
+  {
+    Y y_i;
+    y_reader.reset(y_i);
+    const std::string i_json = "{\"d\": " + std::to_string(i) + ", \"d2\": 0.5" + (i % 3 == 0 ? "]" : "}");
+    for (const char c : i_json)
+    {
+      y_reader.feed(&c, 1);
+    }
+    const auto i_status = y_reader.finish();
+    if (bool(i_status) != (i % 3 != 0) || (i_status && (y_i.d != i || y_i.d2 != 0.5)))
+    {
+      ++num_fails;
+      std::cerr << __FILE__ << ":" << __LINE__ << ", FAIL, " << i_json << ", error: '"
+                << i_status.get_error_message() << "', d: " << y_i.d << "\n";
+    }
+  }
+  return num_fails;
+}
+
 int main()
 {
   const int num_fails = test_writer_mins() + test_writer_maxes() +
+                        test_writer_compact() + test_writer_keys() + test_writer_streams() +
+                        test_writer_numbers() + test_write_file() +
                         test_to_from_object() + test_to_from_vector_objects() +
                         test_to_from_vector() + test_to_from_vector_enums() +
                         test_read_bool() + test_read_i8() + test_read_i16() +
                         test_read_i32() + test_read_i64() + test_read_u8() +
                         test_read_u16() + test_read_u32() + test_read_u64() +
                         test_read_double() + test_read_string() + test_read_enum() +
-                        test_read_object() + test_read_vector() + test_read_versioned_object();
+                        test_read_object() + test_read_vector() + test_read_versioned_object() +
+                        test_read_parse_errors() + test_read_streaming() + test_read_insitu() +
+                        test_read_context() + test_read_error_path() +
+                        test_read_string_view() + test_read_reuse_vector_elements() +
+                        test_read_numeric_arrays() + test_read_json_lines() +
+                        test_read_json_lines_parallel() + test_read_vector_objects_parallel() +
+                        test_read_file_contents() + test_read_file_streaming() + test_read_projection() +
+                        test_read_lazy() + test_writer_native() + test_read_push() +
+                        test_read_keys() + test_read_duplicate_keys() + test_read_schema();
 
   return num_fails == 0 ? 0 : 1;
 }